@@ -1,15 +1,14 @@
 #version 330 core
 
-uniform vec2 iMouse;
-uniform float iTime;
-uniform vec2 iResolution;
+#include "frame.glsl"
+
 uniform sampler2D screenTexture;
 
 in vec2 texCoord;
 out vec4 fragColor;
 
 float motion(in float intensity,in float time) {
-   return (sin(iTime * time) + intensity) / 2.0;
+   return (sin(frame.iTime * time) + intensity) / 2.0;
 }
 
 vec3 rainbow(in float time) {
@@ -20,16 +19,16 @@ vec3 rainbow(in float time) {
 }
 
 vec4 waves( in vec3 Color, in vec2 fragCoord) {
-    vec2 uv =  texCoord + (2.0 * fragCoord - iResolution.xy) / min(iResolution.x, iResolution.y);
+    vec2 uv =  texCoord + (2.0 * fragCoord - frame.iResolution.xy) / min(frame.iResolution.x, frame.iResolution.y);
     for(float i = 1.0; i < 10.0; i++){
-        uv.x += 0.6 / i * cos(i * 2.5* uv.y + iTime);
-        uv.y += 0.6 / i * cos(i * 1.5 * uv.x + iTime);
+        uv.x += 0.6 / i * cos(i * 2.5* uv.y + frame.iTime);
+        uv.y += 0.6 / i * cos(i * 1.5 * uv.x + frame.iTime);
     }
-    return vec4(Color/abs(sin(iTime-uv.y-uv.x)),1.0);   
+    return vec4(Color/abs(sin(frame.iTime-uv.y-uv.x)),1.0);   
 }
 
 vec4 blur(in sampler2D textureSampler, in vec2 texCoord, float intensity) {
-    float blurSize = intensity / iResolution.x;
+    float blurSize = intensity / frame.iResolution.x;
     float weights[9] = float[](0.05, 0.09, 0.12, 0.15, 0.16, 0.15, 0.12, 0.09, 0.05);
     vec4 col = vec4(0.0);
     float total = 0.0;
@@ -46,7 +45,7 @@ vec4 blur(in sampler2D textureSampler, in vec2 texCoord, float intensity) {
 }
 
 vec4 aberration(in sampler2D textureSampler, in vec2 texCoord, float intensity) {
-    vec2 offset = vec2(intensity, -vec2(intensity, 0.0) / iResolution.xy) / iResolution.xy;
+    vec2 offset = vec2(intensity, -vec2(intensity, 0.0) / frame.iResolution.xy) / frame.iResolution.xy;
     float r = texture(textureSampler, texCoord + offset).r;
     float g = texture(textureSampler, texCoord).g;
     float b = texture(textureSampler, texCoord - offset).b;
@@ -55,7 +54,7 @@ vec4 aberration(in sampler2D textureSampler, in vec2 texCoord, float intensity)
 }
 
 vec4 glow(in sampler2D textureSampler, in vec2 texCoord, float intensity) {
-    float blurSize = intensity / iResolution.x; 
+    float blurSize = intensity / frame.iResolution.x; 
     vec4 color = texture(textureSampler, texCoord);
     vec4 blurredColor = vec4(0.0);
     float total = 0.0;
@@ -74,10 +73,10 @@ vec4 glow(in sampler2D textureSampler, in vec2 texCoord, float intensity) {
 
 void mainImage(in vec2 texCoord, in vec2 fragCoord, out vec4 fragColor) {
     fragColor = texture(screenTexture, texCoord)
-    + (aberration(screenTexture,texCoord,sin(iTime/2)*2.0) - texture(screenTexture, texCoord))
-    //+ (blur(screenTexture,texCoord,sin(iTime)*1.0) - texture(screenTexture, texCoord)) 
-    //+ (glow(screenTexture,texCoord,sin(iTime/2)*2.0) - texture(screenTexture, texCoord))
-    //+ (waves(rainbow(iTime),fragCoord))
+    + (aberration(screenTexture,texCoord,sin(frame.iTime/2)*2.0) - texture(screenTexture, texCoord))
+    //+ (blur(screenTexture,texCoord,sin(frame.iTime)*1.0) - texture(screenTexture, texCoord)) 
+    //+ (glow(screenTexture,texCoord,sin(frame.iTime/2)*2.0) - texture(screenTexture, texCoord))
+    //+ (waves(rainbow(frame.iTime),fragCoord))
     ;
 }
 
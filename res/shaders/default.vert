@@ -2,18 +2,17 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec4 aColor;
 
-uniform vec2 iMouse;
-uniform vec2 iResolution;
-uniform float iTime;
+#include "frame.glsl"
 
-uniform mat4 projection;
-uniform mat4 view;
 uniform mat4 model;
 
 out vec2 texCoord;
+out vec4 vertColor;
 
 void main() {
     texCoord = aTexCoords;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vertColor = aColor;
+    gl_Position = frame.projection * frame.view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -1,9 +1,8 @@
 #version 330 core
 
+#include "frame.glsl"
+
 uniform sampler2D Texture;
-uniform vec2 iResolution;
-uniform vec2 iMouse;
-uniform float iTime;
 uniform vec4 Color;
 uniform float Size;
 
@@ -12,7 +11,18 @@ out vec4 fragColor;
 
 void mainImage(in vec2 texCoord, in vec2 fragCoord, out vec4 fragColor) {
     //fragColor = vec4(texCoord, 0.0, 1.0); // uv debug
+#if defined(SDF) // Signed distance atlas, 0.5 on the outline and higher inside
+    float sd = texture(Texture, texCoord).a;
+    float width = max(fwidth(sd), 1e-4);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, sd);
+    fragColor = vec4(Color.rgb, Color.a * alpha);
+#elif defined(CURSOR) // Inverted coverage for the selection
+    vec4 Atlas = texture(Texture, texCoord);
+    Atlas.a = 1.0 - Atlas.a;
+    fragColor = Atlas * Color;
+#else
     fragColor = texture(Texture, texCoord) * Color;
+#endif
 }
 
 void main() {
@@ -0,0 +1,3 @@
+// Deprecated, font.frag built with SHADER_SDF through GetShaderVariant
+#define SDF 1
+#include "font.frag"
@@ -1,8 +1,6 @@
 #version 330 core
 
-uniform float iTime;           // Time in seconds
-uniform vec2 iResolution;      // Resolution of the screen
-uniform vec2 iMouse;           // Mouse position (x, y)
+#include "frame.glsl"
 
 in vec2 texCoord;              // Texture coordinate from vertex shader
 out vec4 fragColor;            // Output color
@@ -38,20 +36,20 @@ vec3 generateColor(float time) {
 
 void mainImage(out vec4 fragColor, in vec2 fragCoord) {
     vec3 col = vec3(0.0);
-    vec2 mouseNormalized = vec2(iMouse.x / iResolution.x - 0.5, iMouse.y / iResolution.y - 0.5) * 2.0;
+    vec2 mouseNormalized = vec2(frame.iMouse.x / frame.iResolution.x - 0.5, frame.iMouse.y / frame.iResolution.y - 0.5) * 2.0;
     mouseNormalized.y = -mouseNormalized.y;
-    float zoomFactor = ZOOM_SPEED * iTime;
+    float zoomFactor = ZOOM_SPEED * frame.iTime;
     float zoom = pow(zoomFactor, ZOOM_EXPONENT);
     vec2 zoomCenter = mouseNormalized;
     #if AA > 1
     for (int m = 0; m < AA; m++) {
         for (int n = 0; n < AA; n++) {
-            vec2 p = (-iResolution.xy + 2.0 * (fragCoord.xy + vec2(float(m), float(n)) / float(AA))) / iResolution.y;
+            vec2 p = (-frame.iResolution.xy + 2.0 * (fragCoord.xy + vec2(float(m), float(n)) / float(AA))) / frame.iResolution.y;
             float w = float(AA * m + n);
-            float time = iTime + 0.5 * (1.0 / 24.0) * w / float(AA * AA);
+            float time = frame.iTime + 0.5 * (1.0 / 24.0) * w / float(AA * AA);
     #else
-            vec2 p = (-iResolution.xy + 2.0 * fragCoord.xy) / iResolution.y;
-            float time = iTime;
+            vec2 p = (-frame.iResolution.xy + 2.0 * fragCoord.xy) / frame.iResolution.y;
+            float time = frame.iTime;
     #endif
             vec2 c = (p - zoomCenter) / zoom + zoomCenter;
             float l = mandelbrot(c);
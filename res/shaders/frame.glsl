@@ -0,0 +1,8 @@
+// Per-frame inputs, filled once per frame in the UBO bound at FRAME_UNIFORMS_BINDING
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    vec2 iResolution;
+    vec2 iMouse;
+    float iTime;
+} frame;
@@ -0,0 +1,20 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec4 aColor;  // Per instance
+layout (location = 3) in mat4 aModel;  // Per instance, takes locations 3 to 6
+layout (location = 7) in vec4 aUVRect; // Per instance: u0, v0, u1, v1
+
+#include "frame.glsl"
+
+uniform mat4 model;
+
+out vec2 texCoord;
+out vec4 vertColor;
+
+void main() {
+    texCoord = mix(aUVRect.xy, aUVRect.zw, aTexCoords);
+    vertColor = aColor;
+    gl_Position = frame.projection * frame.view * model * aModel * vec4(aPos, 1.0);
+}
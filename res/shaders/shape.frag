@@ -0,0 +1,37 @@
+#version 330 core
+
+#define TAU 6.28318530718
+
+#include "frame.glsl"
+
+in vec2 texCoord;
+in vec4 vertColor;
+flat in vec4 shape;
+flat in vec2 arc;
+out vec4 fragColor;
+
+float RoundedBox(vec2 p, vec2 halfSize, float radius) {
+    vec2 q = abs(p) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+float Sector(vec2 p, float start, float end) {
+    float span = mod(end - start, TAU);
+    if (span == 0.0) span = TAU;
+    float t = mod(atan(p.y, p.x) - start, TAU);
+    float len = length(p);
+    if (t <= span) return -min(t, span - t) * len;
+    return min(t - span, TAU - t) * len;
+}
+
+void mainImage(in vec2 texCoord, in vec2 fragCoord, out vec4 fragColor) {
+    float d = RoundedBox(texCoord, shape.xy, shape.z);
+    if (shape.w > 0.0) d = abs(d + shape.w * 0.5) - shape.w * 0.5; // Border only
+    if (arc.x != arc.y) d = max(d, Sector(texCoord, arc.x, arc.y));
+    float alpha = clamp(0.5 - d / max(fwidth(d), 1e-4), 0.0, 1.0);
+    fragColor = vec4(vertColor.rgb, vertColor.a * alpha);
+}
+
+void main() {
+    mainImage(texCoord, gl_FragCoord.xy, fragColor);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords; // Pixel offset from the shape center
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aShape;     // Half width, half height, corner radius, border thickness
+layout (location = 4) in vec2 aArc;       // Start and end angle, equal means closed
+
+#include "frame.glsl"
+
+uniform mat4 model;
+
+out vec2 texCoord;
+out vec4 vertColor;
+flat out vec4 shape;
+flat out vec2 arc;
+
+void main() {
+    texCoord = aTexCoords;
+    vertColor = aColor;
+    shape = aShape;
+    arc = aArc;
+    gl_Position = frame.projection * frame.view * model * vec4(aPos, 1.0);
+}
@@ -1,16 +1,16 @@
 #version 330 core
 
-uniform float iTime;         // Time in seconds
-uniform vec2 iResolution;    // Resolution of the screen
+#include "frame.glsl"
+
 in vec2 texCoord;            // Texture coordinate from vertex shader
 out vec4 fragColor;          // Output color
 
 #define l 120
 
 void mainImage(out vec4 FragColor,vec2 FragCoord) {
-	vec2 v = (FragCoord.xy - iResolution.xy/2.) / min(iResolution.y,iResolution.x) * 30.;
+	vec2 v = (FragCoord.xy - frame.iResolution.xy/2.) / min(frame.iResolution.y,frame.iResolution.x) * 30.;
 	vec2 vv = v;// vec2 vvv = v;
-	float ft = iTime+360.1;
+	float ft = frame.iTime+360.1;
 	float tm = ft*0.1;
 	float tm2 = ft*0.3;
 	vec2 mspt = (vec2(
@@ -32,7 +32,7 @@ void mainImage(out vec4 FragColor,vec2 FragCoord) {
 	vec2 shift = vec2( 0.033, 0.14);
 	vec2 shift2 = vec2( -0.023, -0.22);
 	float Z = 0.4 + mspt.y*0.3;
-	float m = 0.99+sin(iTime*0.03)*0.003;
+	float m = 0.99+sin(frame.iTime*0.03)*0.003;
 	for ( int i = 0; i < l; i++ ){
 		float r = dot(v,v);
 		float r2 = dot(vv,vv);
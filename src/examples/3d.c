@@ -3,6 +3,7 @@
 
 Font font;
 Img img;
+Mesh mesh;
 Vec3 cube;
 double lastscrolly = 0.0;
 double targetZ = 0.0;
@@ -69,14 +70,14 @@ void Update(void) {
         //window.debug.wireframe = true; //window.debug single part
         //DrawCube(1.0f, cube.x, cube.y, cube.z, rot.x, rot.y, rot.z, GRAY);
         BindImg(img);
-        Cube((CubeObject){{
+        DrawMesh(mesh, (Transform){
             cube.x, cube.y, cube.z, // Position: x, y, z
             0.0f, 0.0f, 0.0f,       // LocalPosition: x, y, z
             rot.x, rot.y, rot.z,    // Rotation: x, y, z
-        }, 1.0,                     // Size
+        },
         shaderdefault,              // Shader
-        cam,                        // Camera
-        });
+        cam                         // Camera
+        );
         //window.debug.point = false;
         //window.debug.wireframe = false; //stop debugging
     // Modular ui.h functions
@@ -88,12 +89,14 @@ int main(int argc, char** argv) {
     WindowInit(1920, 1080, "Grafenic - 3d");
     font = LoadFont("./res/fonts/Monocraft.ttf");font.nearest = true;
     img = LoadImage((ImgInfo){"./res/images/Stone.png", true});
+    mesh = LoadMeshCube(1.0f);
     shaderdefault.hotreloading = true;
     while (!WindowState()) {
         WindowClear();
         Update();
         WindowProcess();
     }
+    UnloadMesh(mesh);
     WindowClose();
     return 0;
 }
@@ -0,0 +1,198 @@
+#include "../window.h"
+#include <time.h>
+
+// Matrix math microbenchmark, the reference functions are copies of the scalar code the library had before the
+// SIMD kernels, CalculateProjections included. ./make bench builds both sides at -O2, once for SSE and once with -mavx
+
+static void ReferenceMultiply(const GLfloat* a, const GLfloat* b, GLfloat* result) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            result[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] +
+                                a[i * 4 + 1] * b[1 * 4 + j] +
+                                a[i * 4 + 2] * b[2 * 4 + j] +
+                                a[i * 4 + 3] * b[3 * 4 + j];
+        }
+    }
+}
+
+static void ReferenceRotate(GLfloat angleX, GLfloat angleY, GLfloat angleZ, GLfloat* matrix) {
+    GLfloat cx = cosf(angleX), sx = sinf(angleX);
+    GLfloat cy = cosf(angleY), sy = sinf(angleY);
+    GLfloat cz = cosf(angleZ), sz = sinf(angleZ);
+    GLfloat Rx[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, cx, -sx, 0.0f, 0.0f, sx, cx, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    GLfloat Ry[16] = {cy, 0.0f, sy, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -sy, 0.0f, cy, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    GLfloat Rz[16] = {cz, -sz, 0.0f, 0.0f, sz, cz, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    GLfloat Rxy[16];
+    ReferenceMultiply(Ry, Rx, Rxy);
+    ReferenceMultiply(Rz, Rxy, matrix);
+}
+
+static void ReferenceTranslate(GLfloat tx, GLfloat ty, GLfloat tz, GLfloat* result) {
+    MatrixIdentity(result);
+    result[12] = tx;
+    result[13] = ty;
+    result[14] = tz;
+}
+
+// Model matrix chains of the baseline CalculateProjections, 3D and perspective objects rotate around their position
+static void ReferenceModel(ShaderObject obj, GLfloat* Model) {
+    Vec3 pos = obj.transform.position;
+    Vec3 rot = obj.transform.rotation;
+    float centerX = window.screen_width / 2.0f;
+    float centerY = window.screen_height / 2.0f;
+    GLfloat translateToCenter[16], rotate[16], translateBack[16], translateFinal[16];
+    if (obj.cam.fov > 0.0f || obj.is3d) {
+        ReferenceTranslate(-pos.x, -pos.y, -pos.z, translateToCenter);
+        ReferenceRotate(rot.x, rot.y, rot.z, rotate);
+        ReferenceMultiply(translateToCenter, rotate, Model);
+        ReferenceTranslate(pos.x, pos.y, pos.z, translateBack);
+        ReferenceMultiply(Model, translateBack, Model);
+    } else {
+        ReferenceTranslate(-centerX, -centerY, 0.0f, translateToCenter);
+        ReferenceTranslate(centerX, centerY, 0.0f, translateBack);
+        ReferenceMultiply(translateToCenter, translateBack, translateBack);
+        ReferenceRotate(rot.x, rot.y, rot.z, rotate);
+        ReferenceMultiply(translateBack, rotate, Model);
+        ReferenceTranslate(pos.x, pos.y, 0.0f, translateFinal);
+        ReferenceMultiply(Model, translateFinal, Model);
+    }
+}
+
+static Vec3 ReferenceMultiplyVector(const GLfloat matrix[16], Vec3 vector) {
+    Vec3 result;
+    result.x = matrix[0] * vector.x + matrix[4] * vector.y + matrix[8] * vector.z + matrix[12];
+    result.y = matrix[1] * vector.x + matrix[5] * vector.y + matrix[9] * vector.z + matrix[13];
+    result.z = matrix[2] * vector.x + matrix[6] * vector.y + matrix[10] * vector.z + matrix[14];
+    GLfloat w = matrix[3] * vector.x + matrix[7] * vector.y + matrix[11] * vector.z + matrix[15];
+    if (w != 1.0f && w != 0.0f) {
+        result.x /= w;
+        result.y /= w;
+        result.z /= w;
+    }
+    return result;
+}
+
+static void ReferenceTransformVertices(GLfloat* vertices, size_t vertexCount, const GLfloat* rotationMatrix, const Vec3* positionOffset) {
+    for (size_t i = 0; i < vertexCount; i++) {
+        Vec3 vertex = {vertices[i * FLOAT_PER_VERTEX], vertices[i * FLOAT_PER_VERTEX + 1], vertices[i * FLOAT_PER_VERTEX + 2]};
+        Vec3 rotated = ReferenceMultiplyVector(rotationMatrix, vertex);
+        vertices[i * FLOAT_PER_VERTEX] = rotated.x + positionOffset->x;
+        vertices[i * FLOAT_PER_VERTEX + 1] = rotated.y + positionOffset->y;
+        vertices[i * FLOAT_PER_VERTEX + 2] = rotated.z + positionOffset->z;
+    }
+}
+
+// Timing
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static volatile GLfloat sink; // Keeps the results alive
+
+static float MaxError(const GLfloat* a, const GLfloat* b, size_t count) {
+    float error = 0.0f;
+    for (size_t i = 0; i < count; ++i) error = fmaxf(error, fabsf(a[i] - b[i]));
+    return error;
+}
+
+static void Report(const char* name, double reference, double library, size_t ops, float error) {
+    printf("%-20s reference %8.2f ns  library %8.2f ns  speedup %5.2fx  max error %g\n", name, reference * 1e9 / ops, library * 1e9 / ops, reference / library, error);
+}
+
+int main(int arglenght, char** args)
+{
+    size_t iterations = arglenght > 1 ? strtoul(args[1], NULL, 10) : 2000000;
+    #if defined(__AVX__)
+        printf("Kernels: AVX\n");
+    #elif defined(__SSE__)
+        printf("Kernels: SSE\n");
+    #else
+        printf("Kernels: scalar\n");
+    #endif
+    GLfloat a[16], b[16], expected[16] = {0}, result[16] = {0};
+    for (int i = 0; i < 16; ++i) {
+        a[i] = (i * 7 % 5) * 0.25f - 0.5f;
+        b[i] = (i * 3 % 7) * 0.125f + 0.1f;
+    }
+    // Mat4 multiply
+        double start = Now();
+        for (size_t i = 0; i < iterations; ++i) {
+            a[0] = (GLfloat)(i & 15);
+            ReferenceMultiply(a, b, expected);
+            sink += expected[5];
+        }
+        double reference = Now() - start;
+        start = Now();
+        for (size_t i = 0; i < iterations; ++i) {
+            a[0] = (GLfloat)(i & 15);
+            MatrixMultiply(a, b, result);
+            sink += result[5];
+        }
+        Report("MatrixMultiply", reference, Now() - start, iterations, MaxError(expected, result, 16));
+    // Rotation
+        start = Now();
+        for (size_t i = 0; i < iterations; ++i) {
+            ReferenceRotate(i * 1e-4f, 0.3f, i * 2e-4f, expected);
+            sink += expected[1];
+        }
+        reference = Now() - start;
+        start = Now();
+        for (size_t i = 0; i < iterations; ++i) {
+            MatrixRotate(i * 1e-4f, 0.3f, i * 2e-4f, result);
+            sink += result[1];
+        }
+        Report("MatrixRotate", reference, Now() - start, iterations, MaxError(expected, result, 16));
+    // Model matrix, 3D objects rotate around their position and 2D ones around the origin
+        window.screen_width = 1280;
+        window.screen_height = 720;
+        const char* names[] = {"CalculateModel 3D", "CalculateModel 2D"};
+        for (int is3d = 1; is3d >= 0; --is3d) {
+            ShaderObject obj = {0};
+            obj.is3d = is3d;
+            obj.transform.position = (Vec3){120.0f, 3.0f, -2.0f};
+            start = Now();
+            for (size_t i = 0; i < iterations; ++i) {
+                obj.transform.rotation = (Vec3){0.4f, i * 1e-4f, 1.2f};
+                ReferenceModel(obj, expected);
+                sink += expected[12];
+            }
+            reference = Now() - start;
+            start = Now();
+            for (size_t i = 0; i < iterations; ++i) {
+                obj.transform.rotation = (Vec3){0.4f, i * 1e-4f, 1.2f};
+                CalculateModel(obj, result);
+                sink += result[12];
+            }
+            Report(names[1 - is3d], reference, Now() - start, iterations, MaxError(expected, result, 16) / fmaxf(1.0f, fabsf(expected[12])));
+        }
+    // Vertex arrays
+        size_t count = 4096;
+        size_t rounds = iterations / count > 0 ? iterations / count : 1;
+        GLfloat* source = malloc(count * FLOAT_PER_VERTEX * sizeof(GLfloat));
+        GLfloat* vertices = malloc(count * FLOAT_PER_VERTEX * sizeof(GLfloat));
+        GLfloat* check = malloc(count * FLOAT_PER_VERTEX * sizeof(GLfloat));
+        for (size_t i = 0; i < count * FLOAT_PER_VERTEX; ++i) source[i] = (i % 97) * 0.01f - 0.5f;
+        GLfloat rotation[16];
+        MatrixTRS((Vec3){1.0f, 2.0f, 3.0f}, (Vec3){0.3f, 0.2f, 0.1f}, (Vec3){1.0f, 1.0f, 1.0f}, (Vec3){0.0f, 0.0f, 0.0f}, rotation);
+        Vec3 offset = {0.5f, -0.25f, 0.125f};
+        double transformReference = 0.0, transformLibrary = 0.0;
+        for (size_t r = 0; r < rounds; ++r) {
+            memcpy(check, source, count * FLOAT_PER_VERTEX * sizeof(GLfloat));
+            start = Now();
+            ReferenceTransformVertices(check, count, rotation, &offset);
+            transformReference += Now() - start;
+            memcpy(vertices, source, count * FLOAT_PER_VERTEX * sizeof(GLfloat));
+            start = Now();
+            TransformVertices(vertices, count, rotation, &offset);
+            transformLibrary += Now() - start;
+            sink += vertices[r % count];
+        }
+        Report("TransformVertices", transformReference, transformLibrary, rounds * count, MaxError(check, vertices, count * FLOAT_PER_VERTEX));
+        free(source);
+        free(vertices);
+        free(check);
+    return 0;
+}
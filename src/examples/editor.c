@@ -328,7 +328,7 @@ void DrawEditor(Font font, float fontSize, Color textColor, int cursorLine, int
 int main(int argc, char** argv) {
     WindowInit(1920, 1080, "Grafenic - Text Editor");
     font = LoadFont("./res/fonts/JetBrains.ttf");font.nearest = false;
-    shaderfontcursor = LoadShader("./res/shaders/default.vert", "./res/shaders/fontcursor.frag");
+    shaderfontcursor = GetShaderVariant("./res/shaders/default.vert", "./res/shaders/font.frag", SHADER_CURSOR);
     shaderfontcursor.hotreloading = true;
     shaderdefault.hotreloading = true;
     shaderfont.hotreloading = true;
@@ -0,0 +1,62 @@
+#include "../window.h"
+
+Font font;
+
+int main(int arglenght, char** args)
+{ 
+    window.opt.headless = true;
+    if (WindowInit(640, 360, "Grafenic - Headless") != 0) return 1;
+    font = LoadFont("./res/fonts/JetBrains.ttf");
+    const char* output = arglenght > 1 ? args[1] : "Headless.png";
+    int errors = 0;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        WindowClear();
+        DrawRect(40, 40, 200, 120, (Color){200, 60, 60, 255});
+        DrawCircle(420, 180, 80, (Color){60, 120, 220, 255});
+        DrawText(40, 220, font, 48, "Headless", (Color){255, 255, 255, 255});
+        // The last frame is the golden image
+            if (frame == 2) CaptureScreenshot(output, 0, 0, window.screen_width, window.screen_height);
+        WindowProcess();
+        // Every upload and draw has to be valid in the core profile
+            for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError()) {
+                printf("Headless test failed, GL error 0x%04x on frame %d\n", error, frame);
+                errors++;
+            }
+    }
+    WindowClose(); // Waits for the capture to reach the disk
+    // Read the capture back and check the shapes landed where they were drawn
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(false);
+        unsigned char* pixels = stbi_load(output, &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels || width != 640 || height != 360) {
+            printf("Headless test failed, %s was not captured\n", output);
+            stbi_image_free(pixels);
+            return 1;
+        }
+        struct { int x, y; Color color; } probes[] = {
+            {140, 100, {200, 60, 60, 255}},
+            {420, 180, {60, 120, 220, 255}},
+        };
+        int failures = 0;
+        for (int i = 0; i < 2; ++i) {
+            unsigned char* p = pixels + (probes[i].y * width + probes[i].x) * 4;
+            if (abs(p[0] - probes[i].color.r) > 8 || abs(p[1] - probes[i].color.g) > 8 || abs(p[2] - probes[i].color.b) > 8) {
+                printf("Headless test failed, pixel %d,%d is %d %d %d\n", probes[i].x, probes[i].y, p[0], p[1], p[2]);
+                failures++;
+            }
+        }
+        // The glyphs come from an atlas texture, some of them must have reached the capture
+            int lit = 0;
+            for (int y = 170; y < 300; ++y) {
+                for (int x = 40; x < 300; ++x) lit += pixels[(y * width + x) * 4] > 200;
+            }
+            if (lit < 500) {
+                printf("Headless test failed, only %d text pixels were drawn\n", lit);
+                failures++;
+            }
+        stbi_image_free(pixels);
+        if (failures || errors) return 1;
+    printf("Headless test passed, %s\n", output);
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "../window.h"
+#include "modules/ui.c"
+
+Font font;
+Shader trip;
+Shader aberration;
+RenderTarget background;
+PostProcess post;
+
+int main(int arglenght, char** args)
+{
+    WindowInit(1920, 1080, "Grafenic - Post Process");
+    font = LoadFont("./res/fonts/Monocraft.ttf");font.nearest = true;
+    trip = LoadShader("./res/shaders/default.vert","./res/shaders/trip.frag");
+    aberration = LoadShader("./res/shaders/default.vert","./res/shaders/custom.frag");
+    trip.hotreloading = true;
+    aberration.hotreloading = true;
+    AddPostPass(&post, aberration, 1.0f);
+    while (!WindowState())
+    {
+        WindowClear();
+        // The expensive shader runs at half resolution and is upscaled when drawn
+            if (background.width != window.screen_width / 2 || background.height != window.screen_height / 2) {
+                if (background.framebuffer) UnloadRenderTarget(background);
+                background = LoadRenderTarget(window.screen_width / 2, window.screen_height / 2, false, false);
+            }
+            BeginRenderTarget(background);
+                Rect((RectObject){
+                    {0, window.screen_height, 0.0f},                   // Bottom Left
+                    {window.screen_width, window.screen_height, 0.0f}, // Bottom Right
+                    {0, 0, 0.0f},                                      // Top Left
+                    {window.screen_width, 0, 0.0f},                    // Top Right
+                    trip,                                              // Shader
+                    camera,                                            // Camera
+                });
+            EndRenderTarget();
+        // Scene, run through the aberration pass on the way to the window
+            BeginPostProcess(&post);
+                DrawImage(RenderTargetImage(background), 0, 0, window.screen_width, window.screen_height, 0.0f);
+                DrawRoundedRect(window.screen_width / 2 - 300, window.screen_height / 2 - 120, 600, 240, 32, (Color){20, 20, 20, 160});
+                DrawText(window.screen_width / 2 - 250, window.screen_height / 2 + 20, font, Scaling(60), "Post Process", (Color){255, 255, 255, 255});
+            EndPostProcess(&post);
+        // Modular ui.h functions
+            Fps(0, 0, font, Scaling(50));
+            ExitPromt(font);
+        WindowProcess();
+    }
+    UnloadPostProcess(&post);
+    UnloadRenderTarget(background);
+    WindowClose();
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <dirent.h>
+
+// Texture Atlas
+
+#define TEXTURE_ATLAS_PAGE_SIZE 2048
+#define TEXTURE_ATLAS_PADDING 1 // Edge pixels are repeated into it so linear filtering never bleeds
+
+typedef struct {
+    GLuint texture;
+    unsigned char* pixels;    // CPU copy, written out by SaveTextureAtlas
+    stbrp_context context;
+    stbrp_node* nodes;
+    bool sealed;              // Loaded from disk, the packer state is gone so nothing new goes in
+} AtlasPage;
+
+typedef struct {
+    char* name;
+    int page;
+    int x, y, width, height;  // Pixels inside the page, padding excluded
+} AtlasRect;
+
+typedef struct {
+    AtlasPage* pages;
+    int pagecount;
+    AtlasRect* rects;
+    int rectcount;
+    int rectcapacity;
+    int pagesize;
+    bool nearest;
+} TextureAtlas;
+
+TextureAtlas* CreateTextureAtlas(int pageSize, bool nearest) {
+    TextureAtlas* atlas = calloc(1, sizeof(TextureAtlas));
+    GLint maxSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (pageSize <= 0) pageSize = TEXTURE_ATLAS_PAGE_SIZE;
+    if (pageSize > maxSize) pageSize = maxSize;
+    atlas->pagesize = pageSize;
+    atlas->nearest = nearest;
+    return atlas;
+}
+
+static AtlasPage* TextureAtlasPage(TextureAtlas* atlas, const unsigned char* pixels) {
+    atlas->pages = realloc(atlas->pages, (atlas->pagecount + 1) * sizeof(AtlasPage));
+    AtlasPage* page = &atlas->pages[atlas->pagecount++];
+    *page = (AtlasPage){0};
+    size_t bytes = (size_t)atlas->pagesize * atlas->pagesize * 4;
+    page->pixels = malloc(bytes);
+    if (pixels) {
+        memcpy(page->pixels, pixels, bytes);
+        page->sealed = true;
+    } else {
+        memset(page->pixels, 0, bytes);
+        page->nodes = malloc(atlas->pagesize * sizeof(stbrp_node));
+        stbrp_init_target(&page->context, atlas->pagesize, atlas->pagesize, page->nodes, atlas->pagesize);
+    }
+    glGenTextures(1, &page->texture);
+    StateBindTexture(page->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas->pagesize, atlas->pagesize, 0, GL_RGBA, GL_UNSIGNED_BYTE, page->pixels);
+    glTexOpt(atlas->nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
+    return page;
+}
+
+static void TextureAtlasRect(TextureAtlas* atlas, const char* name, int page, int x, int y, int width, int height) {
+    if (atlas->rectcount == atlas->rectcapacity) {
+        atlas->rectcapacity = atlas->rectcapacity ? atlas->rectcapacity * 2 : 64;
+        atlas->rects = realloc(atlas->rects, atlas->rectcapacity * sizeof(AtlasRect));
+    }
+    atlas->rects[atlas->rectcount++] = (AtlasRect){strdup(name), page, x, y, width, height};
+}
+
+// Sub-rect handle, the texture is the shared page so consecutive draws stay in one batch
+static Img TextureAtlasImage(TextureAtlas* atlas, AtlasRect* rect) {
+    Img img = {0};
+    float size = atlas->pagesize;
+    img.raw = atlas->pages[rect->page].texture;
+    img.width = rect->width;
+    img.height = rect->height;
+    img.channels = 4;
+    img.u0 = rect->x / size;
+    img.v0 = rect->y / size;
+    img.u1 = (rect->x + rect->width) / size;
+    img.v1 = (rect->y + rect->height) / size;
+    return img;
+}
+
+// Packs RGBA pixels (bottom row first, like LoadImage) into the first page with room, opening a new page when none has
+Img AtlasAddBitmap(TextureAtlas* atlas, const char* name, const unsigned char* pixels, int width, int height) {
+    int pad = TEXTURE_ATLAS_PADDING;
+    stbrp_rect packed = {0, width + pad * 2, height + pad * 2};
+    if (packed.w > atlas->pagesize || packed.h > atlas->pagesize) {
+        printf("Image %s (%dx%d) does not fit a %d atlas page\n", name, width, height, atlas->pagesize);
+        return (Img){0};
+    }
+    int index = -1;
+    for (int p = 0; p < atlas->pagecount && index == -1; ++p) {
+        if (!atlas->pages[p].sealed && stbrp_pack_rects(&atlas->pages[p].context, &packed, 1)) index = p;
+    }
+    if (index == -1) {
+        TextureAtlasPage(atlas, NULL);
+        index = atlas->pagecount - 1;
+        stbrp_pack_rects(&atlas->pages[index].context, &packed, 1);
+    }
+    AtlasPage* page = &atlas->pages[index];
+    // Copy into the cell and extrude the border into the padding
+        int cellw = packed.w;
+        int cellh = packed.h;
+        unsigned char* cell = malloc((size_t)cellw * cellh * 4);
+        for (int row = 0; row < cellh; ++row) {
+            int sy = row - pad;
+            if (sy < 0) sy = 0;
+            if (sy >= height) sy = height - 1;
+            for (int col = 0; col < cellw; ++col) {
+                int sx = col - pad;
+                if (sx < 0) sx = 0;
+                if (sx >= width) sx = width - 1;
+                memcpy(cell + ((size_t)row * cellw + col) * 4, pixels + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+        for (int row = 0; row < cellh; ++row) {
+            memcpy(page->pixels + ((size_t)(packed.y + row) * atlas->pagesize + packed.x) * 4, cell + (size_t)row * cellw * 4, cellw * 4);
+        }
+    // Upload only the new cell
+        StateBindTexture(page->texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, packed.x, packed.y, cellw, cellh, GL_RGBA, GL_UNSIGNED_BYTE, cell);
+        free(cell);
+    TextureAtlasRect(atlas, name, index, packed.x + pad, packed.y + pad, width, height);
+    return TextureAtlasImage(atlas, &atlas->rects[atlas->rectcount - 1]);
+}
+
+Img AtlasAddImage(TextureAtlas* atlas, const char* filename) {
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* pixels = stbi_load(filename, &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        printf("Failed to load image %s\n", filename);
+        return (Img){0};
+    }
+    Img img = AtlasAddBitmap(atlas, filename, pixels, width, height);
+    stbi_image_free(pixels);
+    return img;
+}
+
+typedef struct {
+    char* path;
+    int area;
+} AtlasFile;
+
+static int AtlasFileCompare(const void* a, const void* b) {
+    const AtlasFile* fa = a;
+    const AtlasFile* fb = b;
+    if (fa->area != fb->area) return fb->area - fa->area;
+    return strcmp(fa->path, fb->path);
+}
+
+// Adds every image in a directory, largest first since the skyline packer wastes less that way, returns how many went in
+int AtlasAddDirectory(TextureAtlas* atlas, const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        printf("Failed to open directory %s\n", path);
+        return 0;
+    }
+    AtlasFile* files = NULL;
+    int count = 0;
+    struct dirent* item;
+    while ((item = readdir(dir))) {
+        if (item->d_name[0] == '.') continue;
+        char* file = malloc(strlen(path) + strlen(item->d_name) + 2);
+        sprintf(file, "%s/%s", path, item->d_name);
+        int width, height, channels;
+        if (!stbi_info(file, &width, &height, &channels)) {
+            free(file);
+            continue;
+        }
+        files = realloc(files, (count + 1) * sizeof(AtlasFile));
+        files[count++] = (AtlasFile){file, width * height};
+    }
+    closedir(dir);
+    qsort(files, count, sizeof(AtlasFile), AtlasFileCompare);
+    int added = 0;
+    for (int i = 0; i < count; ++i) {
+        if (AtlasAddImage(atlas, files[i].path).raw) added++;
+        free(files[i].path);
+    }
+    free(files);
+    return added;
+}
+
+Img GetAtlasImage(TextureAtlas* atlas, const char* name) {
+    for (int i = 0; i < atlas->rectcount; ++i) {
+        if (strcmp(atlas->rects[i].name, name) == 0) return TextureAtlasImage(atlas, &atlas->rects[i]);
+    }
+    return (Img){0};
+}
+
+// Writes <path> as a plain text index and every page next to it as <path>.<page>.png
+bool SaveTextureAtlas(TextureAtlas* atlas, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Failed to write atlas %s\n", path);
+        return false;
+    }
+    fprintf(file, "atlas %d %d %d\n", atlas->pagesize, atlas->pagecount, atlas->rectcount);
+    for (int i = 0; i < atlas->rectcount; ++i) {
+        AtlasRect* rect = &atlas->rects[i];
+        fprintf(file, "%d %d %d %d %d %s\n", rect->page, rect->x, rect->y, rect->width, rect->height, rect->name);
+    }
+    fclose(file);
+    char* pagepath = malloc(strlen(path) + 16);
+    bool saved = true;
+    // Pages are stored bottom row first, they are flipped here since the stb_image_write flag is shared with the capture workers
+        size_t stride = (size_t)atlas->pagesize * 4;
+        unsigned char* flipped = malloc(stride * atlas->pagesize);
+    for (int p = 0; p < atlas->pagecount; ++p) {
+        for (int y = 0; y < atlas->pagesize; ++y) {
+            memcpy(flipped + y * stride, atlas->pages[p].pixels + (atlas->pagesize - 1 - y) * stride, stride);
+        }
+        sprintf(pagepath, "%s.%d.png", path, p);
+        if (!stbi_write_png(pagepath, atlas->pagesize, atlas->pagesize, 4, flipped, stride)) {
+            printf("Failed to write atlas page %s\n", pagepath);
+            saved = false;
+        }
+    }
+    free(flipped);
+    free(pagepath);
+    return saved;
+}
+
+void UnloadTextureAtlas(TextureAtlas* atlas) {
+    if (!atlas) return;
+    BatchFlush();
+    for (int p = 0; p < atlas->pagecount; ++p) {
+        StateDeleteTexture(atlas->pages[p].texture);
+        free(atlas->pages[p].pixels);
+        free(atlas->pages[p].nodes);
+    }
+    for (int i = 0; i < atlas->rectcount; ++i) {
+        free(atlas->rects[i].name);
+    }
+    free(atlas->pages);
+    free(atlas->rects);
+    free(atlas);
+}
+
+// Reloads a saved atlas without decoding or packing the source images again, images added later go to new pages
+TextureAtlas* LoadTextureAtlas(const char* path, bool nearest) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Failed to open atlas %s\n", path);
+        return NULL;
+    }
+    int pagesize, pagecount, rectcount;
+    if (fscanf(file, "atlas %d %d %d\n", &pagesize, &pagecount, &rectcount) != 3) {
+        printf("Invalid atlas %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+    TextureAtlas* atlas = CreateTextureAtlas(pagesize, nearest);
+    if (atlas->pagesize != pagesize) {
+        printf("Atlas %s pages are larger than GL_MAX_TEXTURE_SIZE\n", path);
+        fclose(file);
+        free(atlas);
+        return NULL;
+    }
+    // Pages
+        char* pagepath = malloc(strlen(path) + 16);
+        stbi_set_flip_vertically_on_load(true);
+        for (int p = 0; p < pagecount; ++p) {
+            sprintf(pagepath, "%s.%d.png", path, p);
+            int width, height, channels;
+            unsigned char* pixels = stbi_load(pagepath, &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels || width != pagesize || height != pagesize) {
+                printf("Failed to load atlas page %s\n", pagepath);
+                stbi_image_free(pixels);
+                free(pagepath);
+                fclose(file);
+                UnloadTextureAtlas(atlas);
+                return NULL;
+            }
+            TextureAtlasPage(atlas, pixels);
+            stbi_image_free(pixels);
+        }
+        free(pagepath);
+    // Rects, the name runs to the end of the line so it may hold spaces
+        char line[4096];
+        for (int i = 0; i < rectcount && fgets(line, sizeof(line), file); ++i) {
+            int page, x, y, width, height, consumed;
+            if (sscanf(line, "%d %d %d %d %d %n", &page, &x, &y, &width, &height, &consumed) != 5 || page < 0 || page >= pagecount) continue;
+            line[strcspn(line, "\n")] = '\0';
+            TextureAtlasRect(atlas, line + consumed, page, x, y, width, height);
+        }
+    fclose(file);
+    return atlas;
+}
@@ -0,0 +1,212 @@
+// Batch Renderer
+
+#define BATCH_FLOAT_PER_VERTEX 15 // position3, uv2, color4, shape4, arc2
+
+#define BLEND_ALPHA 0             // Straight alpha over the target, the default
+#define BLEND_NONE 1              // Overwrites the target
+#define BLEND_PREMULTIPLIED 2     // Source colors are already multiplied by their alpha
+
+typedef struct {
+    int drawcalls;
+    int vertices;
+    int indices;
+} BatchStats;
+
+typedef struct {
+    GLuint VAO;
+    int generation;
+    GLfloat* vertices;
+    GLuint* indices;
+    size_t vertexcount;
+    size_t indexcount;
+    size_t vertexcapacity;
+    size_t indexcapacity;
+    Shader shader;
+    GLuint texture;
+    int blend;
+    int blendmode;         // Mode the next quads are queued with, see BatchBlendMode
+    Camera cam;
+    BatchStats frame;
+    BatchStats stats;
+} Batch;
+
+Batch batch = {0};
+
+// Points the batch VAO at the current vertex ring buffer
+static void BatchAttributes(void) {
+    StateBindVertexArray(batch.VAO);
+    StateBindBuffer(GL_ARRAY_BUFFER, streamvertex.buffer);
+    // Vertex positions attribute (matches aPos in your shader)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)0);
+    // Texture coordinates attribute (matches aTexCoords in your shader)
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    // Vertex color attribute (matches aColor in your shader)
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
+    // Shape attributes (matches aShape and aArc in shape.vert)
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(9 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(13 * sizeof(GLfloat)));
+    batch.generation = streamvertex.generation;
+}
+
+void BatchInit(void) {
+    glGenVertexArrays(1, &batch.VAO);
+    BatchAttributes();
+}
+
+void BatchFlush(void) {
+    if (batch.indexcount == 0) return;
+    // Save the state the caller may rely on
+        GLuint previousTexture = glstate.texture;
+        GLuint previousBlend = glstate.blend;
+    if (batch.shader.hotreloading) batch.shader = ShaderHotReload(batch.shader);
+    // Model Matrix
+        ShaderObject obj = {batch.cam, batch.shader, NULL, NULL, 0, 0, batch.cam.transform};
+        GLfloat Model[16];
+        CalculateModel(obj, Model);
+        UseFrameUniforms(obj);
+    // Depth and Debug
+        SetRenderState(obj);
+    // Blend and Texture
+        StateEnable(GL_BLEND, batch.blend != BLEND_NONE);
+        if (batch.blend == BLEND_ALPHA) StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        if (batch.blend == BLEND_PREMULTIPLIED) StateBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        StateBindTexture(batch.texture);
+    // Append the arena to the ring buffers
+        StateBindVertexArray(batch.VAO);
+        GLintptr vertexoffset = StreamUpload(&streamvertex, batch.vertices, batch.vertexcount * BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat), BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat));
+        GLintptr indexoffset = StreamUpload(&streamindex, batch.indices, batch.indexcount * sizeof(GLuint), sizeof(GLuint));
+        if (batch.generation != streamvertex.generation) BatchAttributes();
+    // Use the shader program
+        StateUseProgram(batch.shader.Program);
+    // Set uniforms
+        glUniformMatrix4fv(batch.shader.locations.model, 1, GL_FALSE, Model);
+        SetFrameUniforms(batch.shader);
+    // Draw using indices
+        glDrawElementsBaseVertex(GL_TRIANGLES, batch.indexcount, GL_UNSIGNED_INT, (void*)indexoffset, vertexoffset / (BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat)));
+    // Restore state
+        if (previousTexture != STATE_UNKNOWN) StateBindTexture(previousTexture);
+        if (previousBlend != STATE_UNKNOWN) StateEnable(GL_BLEND, previousBlend);
+    batch.frame.drawcalls++;
+    batch.frame.vertices += batch.vertexcount;
+    batch.frame.indices += batch.indexcount;
+    batch.vertexcount = 0;
+    batch.indexcount = 0;
+}
+
+void BatchFrame(void) {
+    BatchFlush();
+    batch.stats = batch.frame;
+    batch.frame = (BatchStats){0};
+}
+
+static void BatchReserve(Shader shader, GLuint texture, int blend, Camera cam, size_t vertices, size_t indices) {
+    if (!batch.VAO) BatchInit();
+    if (batch.indexcount > 0 && (
+        batch.shader.Program != shader.Program ||
+        batch.texture != texture ||
+        batch.blend != blend ||
+        memcmp(&batch.cam, &cam, sizeof(Camera)) != 0)) {
+        BatchFlush();
+    }
+    batch.shader = shader;
+    batch.texture = texture;
+    batch.blend = blend;
+    batch.cam = cam;
+    if (batch.vertexcount + vertices > batch.vertexcapacity) {
+        size_t capacity = batch.vertexcapacity ? batch.vertexcapacity : 1024;
+        while (capacity < batch.vertexcount + vertices) capacity *= 2;
+        batch.vertices = realloc(batch.vertices, capacity * BATCH_FLOAT_PER_VERTEX * sizeof(GLfloat));
+        batch.vertexcapacity = capacity;
+    }
+    if (batch.indexcount + indices > batch.indexcapacity) {
+        size_t capacity = batch.indexcapacity ? batch.indexcapacity : 1536;
+        while (capacity < batch.indexcount + indices) capacity *= 2;
+        batch.indices = realloc(batch.indices, capacity * sizeof(GLuint));
+        batch.indexcapacity = capacity;
+    }
+}
+
+static void BatchVertex(Camera cam, Vec3 vert, float u, float v, Color color, const GLfloat* shape) {
+    GLfloat* out = batch.vertices + batch.vertexcount * BATCH_FLOAT_PER_VERTEX;
+    if (cam.fov > 0.0f) { // Perspective projection
+        out[0] = 1.0f - 2.0f * vert.x / window.screen_width;
+        out[1] = 1.0f - 2.0f * vert.y / window.screen_height;
+    } else { // Orthographic projection
+        out[0] = vert.x;
+        out[1] = vert.y;
+    }
+    out[2] = vert.z;
+    out[3] = u;
+    out[4] = v;
+    out[5] = color.r / 255.0f;
+    out[6] = color.g / 255.0f;
+    out[7] = color.b / 255.0f;
+    out[8] = color.a / 255.0f;
+    if (shape) {
+        memcpy(out + 9, shape, 6 * sizeof(GLfloat));
+    } else {
+        memset(out + 9, 0, 6 * sizeof(GLfloat));
+    }
+    batch.vertexcount++;
+}
+
+// Applies to everything queued until it is changed again, draws already queued keep the mode they were queued with
+void BatchBlendMode(int mode) {
+    batch.blendmode = mode;
+}
+
+void BatchTriangle(TriangleObject triangle, GLuint texture, Color color) {
+    BatchReserve(triangle.shader, texture, batch.blendmode, triangle.cam, 3, 3);
+    GLuint base = batch.vertexcount;
+    BatchVertex(triangle.cam, triangle.vert0, 0.0f, 0.0f, color, NULL);
+    BatchVertex(triangle.cam, triangle.vert1, 1.0f, 0.0f, color, NULL);
+    BatchVertex(triangle.cam, triangle.vert2, 0.5f, 1.0f, color, NULL);
+    batch.indices[batch.indexcount++] = base + 0;
+    batch.indices[batch.indexcount++] = base + 1;
+    batch.indices[batch.indexcount++] = base + 2;
+}
+
+static void BatchQuad(RectObject rect, GLuint texture, Color color, float u0, float v0, float u1, float v1, const GLfloat* shape) {
+    BatchReserve(rect.shader, texture, batch.blendmode, rect.cam, 4, 6);
+    GLuint base = batch.vertexcount;
+    BatchVertex(rect.cam, rect.vert0, u0, v0, color, shape); // Bottom Left
+    BatchVertex(rect.cam, rect.vert1, u1, v0, color, shape); // Bottom Right
+    BatchVertex(rect.cam, rect.vert2, u0, v1, color, shape); // Top Left
+    BatchVertex(rect.cam, rect.vert3, u1, v1, color, shape); // Top Right
+    /*
+        2-------3
+        |     / |
+        |   /   |
+        | /     |
+        0-------1
+    */
+    GLuint indices[] = {0, 1, 2, 1, 3, 2};
+    for (int i = 0; i < 6; ++i) {
+        batch.indices[batch.indexcount++] = base + indices[i];
+    }
+}
+
+void BatchRect(RectObject rect, GLuint texture, Color color, float u0, float v0, float u1, float v1) {
+    BatchQuad(rect, texture, color, u0, v0, u1, v1, NULL);
+}
+
+// Signed distance shape drawn by shape.frag, the quad must cover halfWidth/halfHeight around its center plus the anti-aliased edge
+void BatchShape(RectObject rect, Color color, float halfWidth, float halfHeight, float radius, float thickness, float start, float end) {
+    GLfloat shape[] = {halfWidth, halfHeight, radius, thickness, start, end};
+    // Local coordinates follow the quad the caller sized, relative to its center
+        float cx = (rect.vert0.x + rect.vert3.x) * 0.5f;
+        float cy = (rect.vert0.y + rect.vert3.y) * 0.5f;
+    BatchQuad(rect, 0, color, rect.vert0.x - cx, rect.vert0.y - cy, rect.vert3.x - cx, rect.vert3.y - cy, shape);
+}
+
+void BatchTerminate(void) {
+    StateDeleteVertexArray(batch.VAO);
+    free(batch.vertices);
+    free(batch.indices);
+    batch = (Batch){0};
+}
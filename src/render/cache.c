@@ -1,20 +1,39 @@
 // Texture Cache
 
+#define TEXTURE_CACHE_BUDGET (64 * 1024 * 1024) // Default VRAM budget in bytes
+
 typedef struct {
     GLuint texture;
     Color color;
     int width, height;
     bool linear;
     bool isBitmap;
+    uint64_t hash;
+    size_t bytes;
+    int prev, next; // LRU list, most recently used first
+    bool pinned;    // Never evicted, see PinCachedTexture
 } CachedTexture;
 
-static CachedTexture* textureCache = NULL;
-static size_t cacheSize = 0;
+typedef struct {
+    CachedTexture* entries;
+    int* slots;     // Open addressing table of entry indices, -1 when empty
+    size_t capacity;
+    size_t count;
+    size_t entrycapacity;
+    int head, tail;
+    size_t bytes;
+    size_t budget;  // 0 means unlimited
+    int hits;
+    int misses;
+    int evictions;
+} TextureCache;
+
+TextureCache texturecache = {NULL, NULL, 0, 0, 0, -1, -1, 0, TEXTURE_CACHE_BUDGET};
 
 GLuint CreateTextureFromBitmap(const unsigned char* bitmapData, int width, int height, bool linear) {
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateBindTexture(textureID);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bitmapData);
     glTexOpt(linear ? GL_LINEAR : GL_NEAREST, GL_CLAMP_TO_EDGE);
     return textureID;
@@ -23,48 +42,182 @@ GLuint CreateTextureFromBitmap(const unsigned char* bitmapData, int width, int h
 GLuint CreateTextureFromColor(Color color, bool linear) {
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateBindTexture(textureID);
     unsigned char pixels[] = { color.r, color.g, color.b, color.a };
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     glTexOpt(linear ? GL_LINEAR : GL_NEAREST, GL_CLAMP_TO_EDGE);
     return textureID;
 }
 
-GLuint GetCachedTexture(Color color, bool linear, bool isBitmap, const unsigned char* bitmapData, int width, int height) {
-    for (size_t i = 0; i < cacheSize; ++i) {
-        if (textureCache[i].isBitmap == isBitmap &&
-            textureCache[i].width == width &&
-            textureCache[i].height == height &&
-            textureCache[i].linear == linear &&
-            (!isBitmap && textureCache[i].color.r == color.r &&
-             textureCache[i].color.g == color.g &&
-             textureCache[i].color.b == color.b &&
-             textureCache[i].color.a == color.a)) {
-            return textureCache[i].texture;
+static bool TextureCacheMatch(CachedTexture* entry, uint64_t hash, Color color, bool linear, bool isBitmap, int width, int height) {
+    if (entry->hash != hash || entry->isBitmap != isBitmap || entry->linear != linear) return false;
+    if (isBitmap) return entry->width == width && entry->height == height;
+    return entry->color.r == color.r && entry->color.g == color.g && entry->color.b == color.b && entry->color.a == color.a;
+}
+
+static void TextureCacheUnlink(int index) {
+    CachedTexture* entry = &texturecache.entries[index];
+    if (entry->prev != -1) texturecache.entries[entry->prev].next = entry->next; else texturecache.head = entry->next;
+    if (entry->next != -1) texturecache.entries[entry->next].prev = entry->prev; else texturecache.tail = entry->prev;
+}
+
+static void TextureCachePushFront(int index) {
+    CachedTexture* entry = &texturecache.entries[index];
+    entry->prev = -1;
+    entry->next = texturecache.head;
+    if (texturecache.head != -1) texturecache.entries[texturecache.head].prev = index;
+    texturecache.head = index;
+    if (texturecache.tail == -1) texturecache.tail = index;
+}
+
+static size_t TextureCacheSlot(int index) {
+    size_t mask = texturecache.capacity - 1;
+    size_t i = texturecache.entries[index].hash & mask;
+    while (texturecache.slots[i] != index) i = (i + 1) & mask;
+    return i;
+}
+
+static void TextureCacheGrow(void) {
+    size_t capacity = texturecache.capacity ? texturecache.capacity * 2 : 64;
+    free(texturecache.slots);
+    texturecache.slots = malloc(capacity * sizeof(int));
+    memset(texturecache.slots, 0xFF, capacity * sizeof(int));
+    texturecache.capacity = capacity;
+    for (size_t e = 0; e < texturecache.count; ++e) {
+        size_t i = texturecache.entries[e].hash & (capacity - 1);
+        while (texturecache.slots[i] != -1) i = (i + 1) & (capacity - 1);
+        texturecache.slots[i] = e;
+    }
+}
+
+// Drops an entry and keeps both the table and the entry array dense
+static void TextureCacheRemove(int index) {
+    size_t mask = texturecache.capacity - 1;
+    // Backward shift deletion, no tombstones needed
+        size_t hole = TextureCacheSlot(index);
+        size_t i = (hole + 1) & mask;
+        while (texturecache.slots[i] != -1) {
+            size_t home = texturecache.entries[texturecache.slots[i]].hash & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                texturecache.slots[hole] = texturecache.slots[i];
+                hole = i;
+            }
+            i = (i + 1) & mask;
         }
+        texturecache.slots[hole] = -1;
+    TextureCacheUnlink(index);
+    texturecache.bytes -= texturecache.entries[index].bytes;
+    // Move the last entry into the freed index
+        int last = texturecache.count - 1;
+        if (index != last) {
+            texturecache.slots[TextureCacheSlot(last)] = index;
+            CachedTexture* moved = &texturecache.entries[last];
+            if (moved->prev != -1) texturecache.entries[moved->prev].next = index; else texturecache.head = index;
+            if (moved->next != -1) texturecache.entries[moved->next].prev = index; else texturecache.tail = index;
+            texturecache.entries[index] = *moved;
+        }
+        texturecache.count--;
+}
+
+static void TextureCacheEvict(size_t incoming) {
+    if (texturecache.budget == 0) return;
+    bool flushed = false;
+    int index = texturecache.tail;
+    while (index != -1 && texturecache.bytes + incoming > texturecache.budget) {
+        int prev = texturecache.entries[index].prev;
+        if (texturecache.entries[index].pinned) {
+            index = prev;
+            continue;
+        }
+        // The batch may still reference the texture we are about to delete
+            if (!flushed) {
+                BatchFlush();
+                flushed = true;
+            }
+        StateDeleteTexture(texturecache.entries[index].texture);
+        TextureCacheRemove(index);
+        if (prev == (int)texturecache.count) prev = index; // The last entry was moved into the freed index
+        index = prev;
+        texturecache.evictions++;
     }
-    GLuint textureID;
-    if (isBitmap) {
-        textureID = CreateTextureFromBitmap(bitmapData, width, height, linear);
-    } else {
-        textureID = CreateTextureFromColor(color, linear);
+}
+
+// A returned name is only valid until a later GetCachedTexture call evicts it, pin the ones kept across calls
+bool PinCachedTexture(GLuint texture, bool pinned) {
+    for (size_t i = 0; i < texturecache.count; ++i) {
+        if (texturecache.entries[i].texture == texture) {
+            texturecache.entries[i].pinned = pinned;
+            return true;
+        }
     }
-    textureCache = realloc(textureCache, (cacheSize + 1) * sizeof(CachedTexture));
-    textureCache[cacheSize].texture = textureID;
-    textureCache[cacheSize].color = color;
-    textureCache[cacheSize].width = width;
-    textureCache[cacheSize].height = height;
-    textureCache[cacheSize].linear = linear;
-    textureCache[cacheSize].isBitmap = isBitmap;
-    cacheSize++;
+    return false;
+}
+
+GLuint GetCachedTexture(Color color, bool linear, bool isBitmap, const unsigned char* bitmapData, int width, int height) {
+    // Key: color for solids, pixel content for bitmaps
+        uint64_t hash = 14695981039346656037ull;
+        if (isBitmap) {
+            hash = Hash64(&width, sizeof(int), hash);
+            hash = Hash64(&height, sizeof(int), hash);
+            hash = Hash64(bitmapData, (size_t)width * height * 4, hash);
+        } else {
+            hash = Hash64(&color, sizeof(Color), hash);
+        }
+        hash = Hash64(&linear, sizeof(bool), hash);
+        hash = Hash64(&isBitmap, sizeof(bool), hash);
+    // Lookup
+        if (texturecache.capacity) {
+            size_t mask = texturecache.capacity - 1;
+            for (size_t i = hash & mask; texturecache.slots[i] != -1; i = (i + 1) & mask) {
+                int index = texturecache.slots[i];
+                if (TextureCacheMatch(&texturecache.entries[index], hash, color, linear, isBitmap, width, height)) {
+                    TextureCacheUnlink(index);
+                    TextureCachePushFront(index);
+                    texturecache.hits++;
+                    return texturecache.entries[index].texture;
+                }
+            }
+        }
+    // Miss
+        texturecache.misses++;
+        size_t bytes = isBitmap ? (size_t)width * height * 4 : 4;
+        TextureCacheEvict(bytes);
+        GLuint textureID;
+        if (isBitmap) {
+            textureID = CreateTextureFromBitmap(bitmapData, width, height, linear);
+        } else {
+            textureID = CreateTextureFromColor(color, linear);
+        }
+    // Insert
+        if ((texturecache.count + 1) * 4 > texturecache.capacity * 3) TextureCacheGrow();
+        if (texturecache.count == texturecache.entrycapacity) {
+            texturecache.entrycapacity = texturecache.entrycapacity ? texturecache.entrycapacity * 2 : 32;
+            texturecache.entries = realloc(texturecache.entries, texturecache.entrycapacity * sizeof(CachedTexture));
+        }
+        int index = texturecache.count++;
+        texturecache.entries[index] = (CachedTexture){textureID, color, isBitmap ? width : 0, isBitmap ? height : 0, linear, isBitmap, hash, bytes, -1, -1, false};
+        size_t mask = texturecache.capacity - 1;
+        size_t i = hash & mask;
+        while (texturecache.slots[i] != -1) i = (i + 1) & mask;
+        texturecache.slots[i] = index;
+        TextureCachePushFront(index);
+        texturecache.bytes += bytes;
     return textureID;
 }
 
 void CleanUpTextureCache() {
-    for (size_t i = 0; i < cacheSize; ++i) {
-        glDeleteTextures(1, &textureCache[i].texture);
+    BatchFlush();
+    for (size_t i = 0; i < texturecache.count; ++i) {
+        StateDeleteTexture(texturecache.entries[i].texture);
     }
-    free(textureCache);
-    textureCache = NULL;
-    cacheSize = 0;
+    free(texturecache.entries);
+    free(texturecache.slots);
+    texturecache.entries = NULL;
+    texturecache.slots = NULL;
+    texturecache.capacity = 0;
+    texturecache.count = 0;
+    texturecache.entrycapacity = 0;
+    texturecache.head = -1;
+    texturecache.tail = -1;
+    texturecache.bytes = 0;
 }
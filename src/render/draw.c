@@ -1,22 +1,23 @@
+#include "state.c"
+#include "stream.c"
 #include "shader/init.c"
 #include "color.c"
 #include "cache.c"
+#include "batch.c"
+#include "mesh.c"
+#include "instance.c"
 
 void DrawRect(int x, int y, int width, int height, Color color) {
     if (color.a == 0) color.a = 255;
-    GLuint textureID = GetCachedTexture(color, true, false, NULL, 0, 0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    Rect((RectObject){
+    GLuint textureID = GetCachedTexture((Color){255, 255, 255, 255}, true, false, NULL, 0, 0);
+    BatchRect((RectObject){
         {x, y + height, 0.0f},         // Bottom Left
         {x + width, y + height, 0.0f}, // Bottom Right
         {x, y, 0.0f},                  // Top Left
         {x + width, y, 0.0f},          // Top Right
         shaderdefault,                 // Shader
         camera,                        // Camera
-    });
-    UnbindTexture();
+    }, textureID, color, 0.0f, 0.0f, 1.0f, 1.0f);
 }
 
 void DrawRectBorder(int x, int y, int width, int height, int thickness, Color color) {
@@ -44,112 +45,66 @@ void DrawLine(float x0, float y0, float x1, float y1, int thickness, Color color
     GLfloat y4 = y1 + offsetY;
     GLfloat x5 = x1 - offsetX;
     GLfloat y5 = y1 - offsetY;
-    GLuint textureID = GetCachedTexture(color, true, false, NULL, 0, 0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    Rect((RectObject){
+    GLuint textureID = GetCachedTexture((Color){255, 255, 255, 255}, true, false, NULL, 0, 0);
+    BatchRect((RectObject){
         { x2, y2, 0.0f },  // Bottom Left
         { x3, y3, 0.0f },  // Bottom Right
         { x5, y5, 0.0f },  // Top Left
         { x4, y4, 0.0f },  // Top Right
         shaderdefault,     // Shader
         camera,            // Camera
-    });
-    UnbindTexture();
+    }, textureID, color, 0.0f, 0.0f, 1.0f, 1.0f);
+}
+
+// Quad around the shape plus one pixel for the anti-aliased edge
+static void DrawShape(float cx, float cy, float halfWidth, float halfHeight, float radius, float thickness, float start, float end, Color color) {
+    float hw = halfWidth + 1.0f;
+    float hh = halfHeight + 1.0f;
+    BatchShape((RectObject){
+        { cx - hw, cy + hh, 0.0f }, // Bottom Left
+        { cx + hw, cy + hh, 0.0f }, // Bottom Right
+        { cx - hw, cy - hh, 0.0f }, // Top Left
+        { cx + hw, cy - hh, 0.0f }, // Top Right
+        shadershape,                // Shader
+        camera,                     // Camera
+    }, color, halfWidth, halfHeight, radius, thickness, start, end);
 }
 
 void DrawCircle(int x, int y, int r, Color color) {
     if (color.a == 0) color.a = 255;
-    int diameter = r * 2;
-    unsigned char* pixels = (unsigned char*)malloc(diameter * diameter * 4);
-    for (int i = 0; i < diameter; i++) {
-        for (int j = 0; j < diameter; j++) {
-            float dx = i - r;
-            float dy = j - r;
-            float distance = sqrt(dx * dx + dy * dy);
-            if (distance < r) {
-                pixels[(i * diameter + j) * 4] = color.r;
-                pixels[(i * diameter + j) * 4 + 1] = color.g;
-                pixels[(i * diameter + j) * 4 + 2] = color.b;
-                pixels[(i * diameter + j) * 4 + 3] = color.a;
-            } else {
-                pixels[(i * diameter + j) * 4] = 0;
-                pixels[(i * diameter + j) * 4 + 1] = 0;
-                pixels[(i * diameter + j) * 4 + 2] = 0;
-                pixels[(i * diameter + j) * 4 + 3] = 0;
-            }
-        }
-    }
-    GLuint textureID = GetCachedTexture(color, true, true, pixels, diameter, diameter);
-    free(pixels);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    Rect((RectObject){
-        { x - r, y - r, 0.0f }, // Bottom Left
-        { x + r, y - r, 0.0f }, // Bottom Right
-        { x - r, y + r, 0.0f }, // Top Left
-        { x + r, y + r, 0.0f }, // Top Right
-        shaderdefault,          // Shader
-        camera,                 // Camera
-    });
-    UnbindTexture();
+    DrawShape(x, y, r, r, r, 0.0f, 0.0f, 0.0f, color);
 }
 
 void DrawCircleBorder(int x, int y, int r, int thickness, Color color) {
     if (color.a == 0) color.a = 255;
-    int diameter = r * 2 + thickness * 2;
-    unsigned char* pixels = (unsigned char*)malloc(diameter * diameter * 4);
-    for (int i = 0; i < diameter; i++) {
-        for (int j = 0; j < diameter; j++) {
-            float dx = i - r - thickness;
-            float dy = j - r - thickness;
-            float distance = sqrt(dx * dx + dy * dy);
-            if (distance < r + thickness && distance >= r) {
-                pixels[(i * diameter + j) * 4] = color.r;
-                pixels[(i * diameter + j) * 4 + 1] = color.g;
-                pixels[(i * diameter + j) * 4 + 2] = color.b;
-                pixels[(i * diameter + j) * 4 + 3] = color.a;
-            } else {
-                pixels[(i * diameter + j) * 4] = 0;
-                pixels[(i * diameter + j) * 4 + 1] = 0;
-                pixels[(i * diameter + j) * 4 + 2] = 0;
-                pixels[(i * diameter + j) * 4 + 3] = 0;
-            }
-        }
-    }
-    GLuint textureID = GetCachedTexture(color, true, true, pixels, diameter, diameter);
-    free(pixels);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    Rect((RectObject){
-        { x - r - thickness, y - r - thickness, 0.0f }, // Bottom Left
-        { x + r + thickness, y - r - thickness, 0.0f }, // Bottom Right
-        { x - r - thickness, y + r + thickness, 0.0f }, // Top Left
-        { x + r + thickness, y + r + thickness, 0.0f }, // Top Right
-        shaderdefault,                                // Shader
-        camera,                                       // Camera
-    });
-    UnbindTexture();
+    DrawShape(x, y, r + thickness, r + thickness, r + thickness, thickness, 0.0f, 0.0f, color);
+}
+
+void DrawRoundedRect(int x, int y, int width, int height, int radius, Color color) {
+    if (color.a == 0) color.a = 255;
+    float hw = width / 2.0f;
+    float hh = height / 2.0f;
+    DrawShape(x + hw, y + hh, hw, hh, fminf(radius, fminf(hw, hh)), 0.0f, 0.0f, 0.0f, color);
 }
 
+// Angles in radians, clockwise on screen, thickness 0 fills the slice
+void DrawArc(int x, int y, int r, int thickness, float startAngle, float endAngle, Color color) {
+    if (color.a == 0) color.a = 255;
+    if (fabsf(endAngle - startAngle) >= 2.0f * M_PI) startAngle = endAngle = 0.0f;
+    else if (startAngle == endAngle) return;
+    DrawShape(x, y, r + thickness, r + thickness, r + thickness, thickness, startAngle, endAngle, color);
+}
 
 void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color) {
     if (color.a == 0) color.a = 255;
-    GLuint textureID = GetCachedTexture(color, true, false, NULL, 0, 0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    Triangle((TriangleObject){
+    GLuint textureID = GetCachedTexture((Color){255, 255, 255, 255}, true, false, NULL, 0, 0);
+    BatchTriangle((TriangleObject){
         {x1, y1, 0.0f}, // Vert0: x, y, z
         {x2, y2, 0.0f}, // Vert1: x, y, z
         {x3, y3, 0.0f}, // Vert2: x, y, z
         shaderdefault,  // Shader
         camera,         // Camera
-    });
-    UnbindTexture();
+    }, textureID, color);
 }
 
 void DrawTriangleBorder(int x1, int y1, int x2, int y2, int x3, int y3, int thickness, Color color) {
@@ -161,9 +116,9 @@ void DrawTriangleBorder(int x1, int y1, int x2, int y2, int x3, int y3, int thic
 void DrawCube(GLfloat size, GLfloat x, GLfloat y, GLfloat z, GLfloat rotx, GLfloat roty, GLfloat rotz, Color color) {
     if (color.a == 0) color.a = 255;
     GLuint textureID = GetCachedTexture(color, true, false, NULL, 0, 0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    StateEnable(GL_BLEND, true);
+    StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateBindTexture(textureID);
     Cube((CubeObject){{
         x,      y,      z,    // Position: x, y, z
         0.0f,    0.0f,   0.0f, // LocalPosition: x, y, z
@@ -177,3 +132,5 @@ void DrawCube(GLfloat size, GLfloat x, GLfloat y, GLfloat z, GLfloat rotx, GLflo
 
 #include "image.c"
 #include "font.c"
+#include "atlas.c"
+#include "target.c"
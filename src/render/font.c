@@ -4,6 +4,8 @@
 #include FT_GLYPH_H
 #include FT_OUTLINE_H
 #include FT_BITMAP_H
+#include FT_MODULE_H
+#include FT_SIZES_H
 
 #define STB_RECT_PACK_IMPLEMENTATION
 #include <stb_rect_pack.h>
@@ -16,31 +18,83 @@ typedef struct {
     float u1, v1;          // Texture coordinates for the bottom-right corner of the glyph
 } Glyph;
 
-#define MAX_GLYPHS 256
+#define ATLAS_FONT_SIZE 128.0
+#define ATLAS_MAX_SIZE 4096
+#define ATLAS_PADDING 1
+#define ATLAS_SDF_SIZE 64.0 // One distance field atlas serves every size
+#define ATLAS_SDF_SPREAD 8
+
+typedef struct {
+    FT_ULong codepoint;
+    FT_UInt index;         // FreeType glyph index, used for kerning
+    Glyph glyph;
+    int shelf;             // -1 while the glyph is not resident in the atlas
+    int pins;              // Held by retained text meshes, never evicted while > 0
+    bool loaded;           // Slot in use
+    bool missing;          // FreeType could not load it
+} AtlasGlyph;
+
+typedef struct {
+    int y;
+    int height;
+    int x;                 // Next free column
+    unsigned int tick;     // Last use, the coldest shelf is evicted first
+} AtlasShelf;
+
+typedef struct {
+    FT_Face face;
+    FT_Size size;          // Own size object, switching atlases never re-sets the shared face
+    float fontSize;
+    bool subpixel;
+    bool nearest;
+    bool sdf;              // Signed distance instead of coverage, see SHADER_SDF in font.frag
+    int channels;          // 1 for R8 coverage or distance, 4 for subpixel RGBA
+    GLuint textureID;
+    GLuint* retired;       // Textures replaced by a grow, kept for meshes built against them
+    int retiredcount;
+    int width, height;
+    unsigned char* pixels; // CPU copy, used to carry glyphs over when growing
+    AtlasShelf* shelves;
+    int shelfcount;
+    int shelfcapacity;
+    int bottom;            // First row not covered by a shelf
+    AtlasGlyph* slots;     // Open addressing table keyed by codepoint
+    size_t capacity;
+    size_t count;
+    unsigned int tick;
+    unsigned int version;  // Bumped whenever resident glyphs move or leave, cached text quads check it
+    int lineheight;
+    int rasterized;
+    int evictions;
+} FontAtlas;
 
 typedef struct {
     FT_Library library;        // FreeType library instance
     FT_Face face;              // Font face
-    unsigned char* atlasData;  // Atlas texture data
-    GLuint textureID;          // OpenGL texture ID
+    FontAtlas* atlas;          // Glyphs rasterized on first use
     int oversampling;          // Dimensions of the oversampling
-    int atlasWidth;            // Dimensions of the atlas Width
-    int atlasHeight;           // Dimensions of the atlas Height
-    Glyph glyphs[MAX_GLYPHS];  // Glyph data for ASCII characters 32-127
-    float fontSize;            // Font size for which glyphs were generated
+    float fontSize;            // Font size for which glyphs are rasterized
     bool nearest;              // Nearest filter
-    bool subpixel;              // Subpixel
+    bool subpixel;             // Subpixel
+    bool sdf;                  // Signed distance field atlas, crisp at any size
 } Font;
 
-#define ATLAS_FONT_SIZE 128.0
+typedef struct {
+    char* path;
+    FT_Face face;
+} FontFace;
 
-typedef struct FontCacheNode {
-    float fontSize;
-    Font font;
-    struct FontCacheNode* next;
-} FontCacheNode;
+typedef struct {
+    FT_Library library;    // One per process, shared by every face
+    FontFace* faces;       // Keyed by path, a file is opened once however many sizes use it
+    int facecount;
+    int facecapacity;
+    FontAtlas** atlases;   // Open addressing table keyed by face, size and mode, NULL when empty
+    size_t capacity;
+    size_t count;
+} FontRegistry;
 
-FontCacheNode* fontCache = NULL;
+FontRegistry fontregistry = {0};
 
 int CalculateAtlasSize(int numGlyphs, float fontSize, int oversampling) {
     float estimatedAreaPerGlyph = (fontSize * fontSize) * oversampling * oversampling;
@@ -53,145 +107,370 @@ int CalculateAtlasSize(int numGlyphs, float fontSize, int oversampling) {
     return powerOfTwo;
 }
 
-Font GenAtlas(Font font) {
-    if (font.fontSize <= 1) font.fontSize = ATLAS_FONT_SIZE;
-    if (font.oversampling <= 1) font.oversampling = 4;
-    if (!font.face) return font;
-    FT_Error error = FT_Set_Pixel_Sizes(font.face, 0, font.fontSize);
-    if (error) {
-        return font;
+// Glyph Atlas
+
+static void FontAtlasTexture(FontAtlas* atlas) {
+    glGenTextures(1, &atlas->textureID);
+    StateBindTexture(atlas->textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (atlas->channels == 1) {
+        // Coverage only, sampled as white with the coverage in alpha
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlas->width, atlas->height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas->pixels);
+            GLint swizzle[] = {GL_ONE, GL_ONE, GL_ONE, GL_RED};
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas->width, atlas->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas->pixels);
     }
-    if (font.subpixel) FT_Library_SetLcdFilter(font.library, FT_LCD_FILTER_DEFAULT);
-    int estimatedAtlasSize = CalculateAtlasSize(MAX_GLYPHS, font.fontSize, font.oversampling);
-    font.atlasWidth = estimatedAtlasSize;
-    font.atlasHeight = estimatedAtlasSize;
-    font.atlasData = (unsigned char*)calloc(font.atlasWidth * font.atlasHeight * 4, sizeof(unsigned char));
-    if (!font.atlasData) {
-        FT_Done_Face(font.face);
-        FT_Done_FreeType(font.library);
-        return font;
-    }
-    stbrp_context packContext;
-    stbrp_node* nodes = (stbrp_node*)malloc(sizeof(stbrp_node) * font.atlasWidth);
-    stbrp_init_target(&packContext, font.atlasWidth, font.atlasHeight, nodes, font.atlasWidth);
-    stbrp_rect* rects = (stbrp_rect*)malloc(sizeof(stbrp_rect) * MAX_GLYPHS);
-    for (int i = 0; i < MAX_GLYPHS; ++i) {
-        int codepoint = 32 + i;
-        if (font.subpixel) {
-            error = FT_Load_Char(font.face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LCD);
-        } else {
-            error = FT_Load_Char(font.face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexOpt(atlas->nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
+}
+
+static void FontAtlasActivate(FontAtlas* atlas) {
+    if (atlas->face->size != atlas->size) FT_Activate_Size(atlas->size);
+}
+
+FontAtlas* LoadFontAtlas(FT_Face face, float fontSize, bool subpixel, bool nearest, bool sdf) {
+    FontAtlas* atlas = calloc(1, sizeof(FontAtlas));
+    atlas->face = face;
+    if (FT_New_Size(face, &atlas->size)) {
+        printf("Failed to create a FreeType size for %.1fpx\n", fontSize);
+        free(atlas);
+        return NULL;
+    }
+    atlas->fontSize = fontSize;
+    atlas->sdf = sdf;
+    atlas->subpixel = subpixel && !sdf;
+    atlas->nearest = nearest && !sdf;
+    atlas->channels = atlas->subpixel ? 4 : 1;
+    // Room for about a line of glyphs, the atlas grows as text needs more
+        int size = CalculateAtlasSize(32, fontSize, 1);
+        if (size < 256) size = 256;
+        if (size > ATLAS_MAX_SIZE) size = ATLAS_MAX_SIZE;
+        atlas->width = size;
+        atlas->height = size;
+        atlas->pixels = calloc((size_t)size * size, atlas->channels);
+    FT_Activate_Size(atlas->size);
+    FT_Set_Pixel_Sizes(face, 0, fontSize);
+    atlas->lineheight = face->size->metrics.height >> 6;
+    atlas->version = 1;
+    FontAtlasTexture(atlas);
+    return atlas;
+}
+
+static AtlasGlyph* FontAtlasSlot(FontAtlas* atlas, FT_ULong codepoint) {
+    if ((atlas->count + 1) * 4 > atlas->capacity * 3) {
+        size_t capacity = atlas->capacity ? atlas->capacity * 2 : 256;
+        AtlasGlyph* slots = calloc(capacity, sizeof(AtlasGlyph));
+        for (size_t i = 0; i < atlas->capacity; ++i) {
+            if (!atlas->slots[i].loaded) continue;
+            size_t j = atlas->slots[i].codepoint & (capacity - 1);
+            while (slots[j].loaded) j = (j + 1) & (capacity - 1);
+            slots[j] = atlas->slots[i];
         }
-        if (error) {
-            rects[i].w = rects[i].h = 0;
-            rects[i].id = i;
-            continue;
+        free(atlas->slots);
+        atlas->slots = slots;
+        atlas->capacity = capacity;
+    }
+    size_t mask = atlas->capacity - 1;
+    size_t i = codepoint & mask;
+    while (atlas->slots[i].loaded && atlas->slots[i].codepoint != codepoint) i = (i + 1) & mask;
+    return &atlas->slots[i];
+}
+
+static void FontAtlasUV(FontAtlas* atlas, Glyph* glyph) {
+    glyph->u0 = glyph->x0 / (float)atlas->width;
+    glyph->v0 = glyph->y0 / (float)atlas->height;
+    glyph->u1 = glyph->x1 / (float)atlas->width;
+    glyph->v1 = glyph->y1 / (float)atlas->height;
+}
+
+// Doubles the atlas, the old texture stays alive for meshes that still point at it
+static bool FontAtlasGrow(FontAtlas* atlas) {
+    GLint maxSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (maxSize > ATLAS_MAX_SIZE) maxSize = ATLAS_MAX_SIZE;
+    if (atlas->width * 2 > maxSize) return false;
+    int width = atlas->width * 2;
+    int height = atlas->height * 2;
+    unsigned char* pixels = calloc((size_t)width * height, atlas->channels);
+    for (int row = 0; row < atlas->height; ++row) {
+        memcpy(pixels + (size_t)row * width * atlas->channels, atlas->pixels + (size_t)row * atlas->width * atlas->channels, atlas->width * atlas->channels);
+    }
+    free(atlas->pixels);
+    atlas->pixels = pixels;
+    atlas->width = width;
+    atlas->height = height;
+    atlas->retired = realloc(atlas->retired, (atlas->retiredcount + 1) * sizeof(GLuint));
+    atlas->retired[atlas->retiredcount++] = atlas->textureID;
+    FontAtlasTexture(atlas);
+    for (size_t i = 0; i < atlas->capacity; ++i) {
+        if (atlas->slots[i].loaded && atlas->slots[i].shelf >= 0) FontAtlasUV(atlas, &atlas->slots[i].glyph);
+    }
+    atlas->version++;
+    return true;
+}
+
+// Drops every glyph of the coldest shelf that is tall enough and not in use this draw
+static int FontAtlasEvict(FontAtlas* atlas, int height) {
+    bool* pinned = calloc(atlas->shelfcount, sizeof(bool));
+    for (size_t i = 0; i < atlas->capacity; ++i) {
+        AtlasGlyph* entry = &atlas->slots[i];
+        if (entry->loaded && entry->shelf >= 0 && entry->pins > 0) pinned[entry->shelf] = true;
+    }
+    int victim = -1;
+    for (int s = 0; s < atlas->shelfcount; ++s) {
+        AtlasShelf* shelf = &atlas->shelves[s];
+        if (pinned[s] || shelf->tick == atlas->tick || shelf->height < height) continue;
+        if (victim == -1 || shelf->tick < atlas->shelves[victim].tick) victim = s;
+    }
+    free(pinned);
+    if (victim == -1) return -1;
+    for (size_t i = 0; i < atlas->capacity; ++i) {
+        if (atlas->slots[i].loaded && atlas->slots[i].shelf == victim) atlas->slots[i].shelf = -1;
+    }
+    atlas->shelves[victim].x = 0;
+    atlas->evictions++;
+    atlas->version++;
+    return victim;
+}
+
+static int FontAtlasPlace(FontAtlas* atlas, int width, int height) {
+    // Best fitting shelf with room left
+        int best = -1;
+        for (int s = 0; s < atlas->shelfcount; ++s) {
+            AtlasShelf* shelf = &atlas->shelves[s];
+            if (shelf->height < height || shelf->x + width > atlas->width) continue;
+            if (best == -1 || shelf->height < atlas->shelves[best].height) best = s;
         }
-        FT_GlyphSlot slot = font.face->glyph;
-        FT_Bitmap* bitmap = &slot->bitmap;
-        rects[i].id = i;
-        rects[i].w = font.subpixel ? (bitmap->width / 3) + 2 : bitmap->width + 2;
-        rects[i].h = bitmap->rows + 2;
-    }
-    stbrp_pack_rects(&packContext, rects, MAX_GLYPHS);
-    for (int i = 0; i < MAX_GLYPHS; ++i) {
-        if (!rects[i].was_packed) continue;
-        int codepoint = 32 + i;
-        if (font.subpixel) {
-            error = FT_Load_Char(font.face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LCD);
-        } else {
-            error = FT_Load_Char(font.face, codepoint, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT);
+        if (best != -1 && atlas->shelves[best].height <= height + height / 4 + 2) return best;
+    // New shelf below the others
+        if (atlas->bottom + height <= atlas->height) {
+            if (atlas->shelfcount == atlas->shelfcapacity) {
+                atlas->shelfcapacity = atlas->shelfcapacity ? atlas->shelfcapacity * 2 : 16;
+                atlas->shelves = realloc(atlas->shelves, atlas->shelfcapacity * sizeof(AtlasShelf));
+            }
+            atlas->shelves[atlas->shelfcount] = (AtlasShelf){atlas->bottom, height, 0, atlas->tick};
+            atlas->bottom += height;
+            return atlas->shelfcount++;
+        }
+    if (best != -1) return best;
+    int evicted = FontAtlasEvict(atlas, height);
+    if (evicted != -1 && width <= atlas->width) return evicted;
+    if (FontAtlasGrow(atlas)) return FontAtlasPlace(atlas, width, height);
+    return -1;
+}
+
+static void FontAtlasRasterize(FontAtlas* atlas, AtlasGlyph* entry) {
+    FT_Face face = atlas->face;
+    FontAtlasActivate(atlas);
+    if (atlas->sdf) {
+        if (FT_Load_Glyph(face, entry->index, FT_LOAD_DEFAULT) || FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF)) {
+            entry->missing = true;
+            return;
         }
-        if (error) continue;
-        FT_GlyphSlot slot = font.face->glyph;
-        FT_Bitmap* bitmap = &slot->bitmap;
-        int x = rects[i].x;
-        int y = rects[i].y;
-       if (font.subpixel) {
-            for (int row = 0; row < bitmap->rows; ++row) {
-                for (int col = 0; col < bitmap->width; col += 3) {
-                    int srcIndex = row * bitmap->pitch + col;
-                    int dstIndex = ((y + row) * font.atlasWidth + (x + col / 3)) * 4;
-                    font.atlasData[dstIndex + 0] = bitmap->buffer[srcIndex + 0];
-                    font.atlasData[dstIndex + 1] = bitmap->buffer[srcIndex + 1];
-                    font.atlasData[dstIndex + 2] = bitmap->buffer[srcIndex + 2];
-                    font.atlasData[dstIndex + 3] = bitmap->buffer[srcIndex + 3];
+    } else {
+        FT_Int32 flags = FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT;
+        if (atlas->subpixel) flags |= FT_LOAD_TARGET_LCD;
+        if (FT_Load_Glyph(face, entry->index, flags)) {
+            entry->missing = true;
+            return;
+        }
+    }
+    FT_GlyphSlot slot = face->glyph;
+    FT_Bitmap* bitmap = &slot->bitmap;
+    int w = atlas->subpixel ? bitmap->width / 3 : bitmap->width;
+    int h = bitmap->rows;
+    Glyph* glyph = &entry->glyph;
+    glyph->xoff = slot->bitmap_left;
+    glyph->yoff = slot->bitmap_top;
+    glyph->xadvance = slot->advance.x >> 6;
+    int shelfIndex = FontAtlasPlace(atlas, w + ATLAS_PADDING * 2, h + ATLAS_PADDING * 2);
+    if (shelfIndex == -1) return;
+    AtlasShelf* shelf = &atlas->shelves[shelfIndex];
+    int x = shelf->x;
+    int y = shelf->y;
+    shelf->x += w + ATLAS_PADDING * 2;
+    // Copy coverage into the padded cell
+        int cellw = w + ATLAS_PADDING * 2;
+        int cellh = h + ATLAS_PADDING * 2;
+        int channels = atlas->channels;
+        unsigned char* cell = calloc((size_t)cellw * cellh, channels);
+        for (int row = 0; row < h; ++row) {
+            unsigned char* src = bitmap->buffer + row * bitmap->pitch;
+            unsigned char* dst = cell + ((size_t)(row + ATLAS_PADDING) * cellw + ATLAS_PADDING) * channels;
+            if (atlas->subpixel) {
+                for (int col = 0; col < w; ++col) {
+                    dst[col * 4 + 0] = src[col * 3 + 0];
+                    dst[col * 4 + 1] = src[col * 3 + 1];
+                    dst[col * 4 + 2] = src[col * 3 + 2];
+                    dst[col * 4 + 3] = (src[col * 3 + 0] + src[col * 3 + 1] + src[col * 3 + 2]) / 3;
                 }
+            } else {
+                memcpy(dst, src, w);
             }
-        } else {
-            for (int row = 0; row < bitmap->rows; ++row) {
-                for (int col = 0; col < bitmap->width; ++col) {
-                    int srcIndex = row * bitmap->pitch + col;
-                    int dstIndex = ((y + row) * font.atlasWidth + (x + col)) * 4;
-                    font.atlasData[dstIndex + 0] = 255;
-                    font.atlasData[dstIndex + 1] = 255;
-                    font.atlasData[dstIndex + 2] = 255;
-                    font.atlasData[dstIndex + 3] = bitmap->buffer[srcIndex];    
-                }
+        }
+        for (int row = 0; row < cellh; ++row) {
+            memcpy(atlas->pixels + ((size_t)(y + row) * atlas->width + x) * channels, cell + (size_t)row * cellw * channels, cellw * channels);
+        }
+    // Upload only the new cell
+        StateBindTexture(atlas->textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, cellw, cellh, channels == 1 ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, cell);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        free(cell);
+    glyph->x0 = x + ATLAS_PADDING;
+    glyph->y0 = y + ATLAS_PADDING;
+    glyph->x1 = glyph->x0 + w;
+    glyph->y1 = glyph->y0 + h;
+    FontAtlasUV(atlas, glyph);
+    entry->shelf = shelfIndex;
+    atlas->rasterized++;
+}
+
+// Returns the glyph for codepoint, rasterizing it into the atlas on first use
+AtlasGlyph* GetFontGlyph(FontAtlas* atlas, FT_ULong codepoint) {
+    AtlasGlyph* entry = FontAtlasSlot(atlas, codepoint);
+    if (!entry->loaded) {
+        *entry = (AtlasGlyph){0};
+        entry->codepoint = codepoint;
+        entry->index = FT_Get_Char_Index(atlas->face, codepoint);
+        entry->shelf = -1;
+        entry->loaded = true;
+        atlas->count++;
+    }
+    if (entry->shelf == -1 && !entry->missing) FontAtlasRasterize(atlas, entry);
+    if (entry->shelf >= 0) atlas->shelves[entry->shelf].tick = atlas->tick;
+    return entry;
+}
+
+void SetFontAtlasFilter(FontAtlas* atlas, bool nearest) {
+    if (atlas->sdf || atlas->nearest == nearest) return;
+    atlas->nearest = nearest;
+    StateBindTexture(atlas->textureID);
+    glTexOpt(nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
+}
+
+static void TextLayoutSweep(FontAtlas* atlas, unsigned int before);
+
+void UnloadFontAtlas(FontAtlas* atlas) {
+    if (!atlas) return;
+    TextLayoutSweep(atlas, ~0u);
+    StateDeleteTexture(atlas->textureID);
+    for (int i = 0; i < atlas->retiredcount; ++i) {
+        StateDeleteTexture(atlas->retired[i]);
+    }
+    free(atlas->retired);
+    free(atlas->pixels);
+    free(atlas->shelves);
+    free(atlas->slots);
+    FT_Done_Size(atlas->size);
+    free(atlas);
+}
+
+// Font Registry
+
+static FT_Face FontRegistryFace(const char* path) {
+    for (int i = 0; i < fontregistry.facecount; ++i) {
+        if (strcmp(fontregistry.faces[i].path, path) == 0) return fontregistry.faces[i].face;
+    }
+    if (!fontregistry.library && FT_Init_FreeType(&fontregistry.library)) {
+        printf("Failed to initialize FreeType\n");
+        fontregistry.library = NULL;
+        return NULL;
+    }
+    FT_Face face;
+    if (FT_New_Face(fontregistry.library, path, 0, &face)) {
+        printf("Failed to load font %s\n", path);
+        return NULL;
+    }
+    if (fontregistry.facecount == fontregistry.facecapacity) {
+        fontregistry.facecapacity = fontregistry.facecapacity ? fontregistry.facecapacity * 2 : 4;
+        fontregistry.faces = realloc(fontregistry.faces, fontregistry.facecapacity * sizeof(FontFace));
+    }
+    fontregistry.faces[fontregistry.facecount++] = (FontFace){strdup(path), face};
+    return face;
+}
+
+static uint64_t FontRegistryHash(FT_Face face, float fontSize, bool subpixel, bool sdf) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = Hash64(&face, sizeof(FT_Face), hash);
+    hash = Hash64(&fontSize, sizeof(float), hash);
+    hash = Hash64(&subpixel, sizeof(bool), hash);
+    return Hash64(&sdf, sizeof(bool), hash);
+}
+
+static void FontRegistryGrow(void) {
+    size_t capacity = fontregistry.capacity ? fontregistry.capacity * 2 : 16;
+    FontAtlas** atlases = calloc(capacity, sizeof(FontAtlas*));
+    for (size_t i = 0; i < fontregistry.capacity; ++i) {
+        FontAtlas* atlas = fontregistry.atlases[i];
+        if (!atlas) continue;
+        size_t j = FontRegistryHash(atlas->face, atlas->fontSize, atlas->subpixel, atlas->sdf) & (capacity - 1);
+        while (atlases[j]) j = (j + 1) & (capacity - 1);
+        atlases[j] = atlas;
+    }
+    free(fontregistry.atlases);
+    fontregistry.atlases = atlases;
+    fontregistry.capacity = capacity;
+}
+
+// Returns the shared atlas of face at fontSize in the given mode, creating it on first use
+FontAtlas* GetFontAtlas(FT_Face face, float fontSize, bool subpixel, bool nearest, bool sdf) {
+    subpixel = subpixel && !sdf;
+    uint64_t hash = FontRegistryHash(face, fontSize, subpixel, sdf);
+    // Lookup
+        if (fontregistry.capacity) {
+            size_t mask = fontregistry.capacity - 1;
+            for (size_t i = hash & mask; fontregistry.atlases[i]; i = (i + 1) & mask) {
+                FontAtlas* atlas = fontregistry.atlases[i];
+                if (atlas->face == face && atlas->fontSize == fontSize && atlas->subpixel == subpixel && atlas->sdf == sdf) return atlas;
             }
         }
-        Glyph* glyph = &font.glyphs[i];
-        glyph->x0 = x;
-        glyph->y0 = y;
-        glyph->x1 = x + (font.subpixel ? bitmap->width / 3 : bitmap->width);
-        glyph->y1 = y + bitmap->rows;
-        glyph->xoff = slot->bitmap_left;
-        glyph->yoff = slot->bitmap_top;
-        glyph->xadvance = slot->advance.x >> 6;
-        glyph->u0 = (float)glyph->x0 / (float)font.atlasWidth;
-        glyph->v0 = (float)glyph->y0 / (float)font.atlasHeight;
-        glyph->u1 = (float)glyph->x1 / (float)font.atlasWidth;
-        glyph->v1 = (float)glyph->y1 / (float)font.atlasHeight;
-    }
-    glGenTextures(1, &font.textureID);
-    glBindTexture(GL_TEXTURE_2D, font.textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, font.atlasWidth, font.atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, font.atlasData);
-    glTexOpt(font.nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
-    //stbi_write_jpg("/tmp/atlas.jpg", font.atlasWidth, font.atlasHeight, 1, font.atlasData, font.atlasWidth);
-    free(font.atlasData);
-    font.atlasData = NULL;
-    free(nodes);
-    free(rects);
+    // Insert
+        FontAtlas* atlas = LoadFontAtlas(face, fontSize, subpixel, nearest, sdf);
+        if (!atlas) return NULL;
+        if ((fontregistry.count + 1) * 4 > fontregistry.capacity * 3) FontRegistryGrow();
+        size_t mask = fontregistry.capacity - 1;
+        size_t i = hash & mask;
+        while (fontregistry.atlases[i]) i = (i + 1) & mask;
+        fontregistry.atlases[i] = atlas;
+        fontregistry.count++;
+    return atlas;
+}
+
+Font GenAtlas(Font font) {
+    if (font.fontSize <= 1) font.fontSize = ATLAS_FONT_SIZE;
+    if (font.oversampling <= 1) font.oversampling = 4;
+    if (!font.face) return font;
+    if (font.subpixel) FT_Library_SetLcdFilter(font.library, FT_LCD_FILTER_DEFAULT);
+    if (font.sdf) {
+        FT_Int spread = ATLAS_SDF_SPREAD;
+        FT_Property_Set(font.library, "sdf", "spread", &spread);
+        FT_Property_Set(font.library, "bsdf", "spread", &spread);
+    }
+    font.atlas = GetFontAtlas(font.face, font.fontSize, font.subpixel, font.nearest, font.sdf);
     return font;
 }
 
+// Faces and atlases come from the registry, loading the same file or size twice costs nothing
 Font LoadFont(const char* fontPath) {
     Font font = {0};
-    FT_Error error = FT_Init_FreeType(&font.library);
-    if (error) {
-        return font;
-    }
-    error = FT_New_Face(font.library, fontPath, 0, &font.face);
-    if (error == FT_Err_Unknown_File_Format) {
-        FT_Done_FreeType(font.library);
-        return font;
-    } else if (error) {
-        FT_Done_FreeType(font.library);
-        return font;
-    }
-    if (font.fontSize <= 1) font.fontSize = ATLAS_FONT_SIZE;
-    if (font.oversampling <= 1) font.oversampling = 1;
+    font.face = FontRegistryFace(fontPath);
+    if (!font.face) return font;
+    font.library = fontregistry.library;
+    font.fontSize = ATLAS_FONT_SIZE;
+    font.oversampling = 1;
     font = GenAtlas(font);
     return font;
 }
 
 Font SetFontSize(Font font, float fontSize) {
     if (fontSize <= 1) fontSize = ATLAS_FONT_SIZE;
-    FontCacheNode* node = fontCache;
-    while (node) {
-        if (node->fontSize == fontSize) {
-            return node->font;
-        }
-        node = node->next;
-    }
+    if (font.sdf) fontSize = ATLAS_SDF_SIZE;
+    FontAtlas* atlas = font.atlas;
+    if (atlas && atlas->face == font.face && atlas->fontSize == fontSize && atlas->sdf == font.sdf && atlas->subpixel == (font.subpixel && !font.sdf)) return font;
     font.fontSize = fontSize;
-    font = GenAtlas(font);
-    FontCacheNode* newNode = (FontCacheNode*)malloc(sizeof(FontCacheNode));
-    newNode->fontSize = fontSize;
-    newNode->font = font;
-    newNode->next = fontCache;
-    fontCache = newNode;
-    return font;
+    return GenAtlas(font);
 }
 
 typedef struct {
@@ -199,201 +478,341 @@ typedef struct {
     int height;
 } TextSize;
 
-TextSize GetTextSize(Font font, float fontSize, const char* text) {
-    if (!font.face) return (TextSize){0, 0};
-    TextSize size = {0, 0};
-    FT_Error error = FT_Set_Pixel_Sizes(font.face, 0, fontSize);
-    if (error) {
-        return size;
+// UTF-8
+
+// Decodes the codepoint at text[*i] and moves *i past it, malformed bytes decode to U+FFFD one byte at a time
+FT_ULong DecodeUTF8(const char* text, size_t* i) {
+    const unsigned char* s = (const unsigned char*)text + *i;
+    static const FT_ULong minimum[] = {0, 0, 0x80, 0x800, 0x10000};
+    FT_ULong codepoint;
+    int length;
+    if (s[0] < 0x80) {
+        (*i)++;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        codepoint = s[0] & 0x1F;
+        length = 2;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        codepoint = s[0] & 0x0F;
+        length = 3;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        codepoint = s[0] & 0x07;
+        length = 4;
+    } else {
+        (*i)++;
+        return 0xFFFD;
     }
-    FT_Face face = font.face;
-    FT_GlyphSlot slot = face->glyph;
-    int ascent = face->size->metrics.ascender >> 6;
-    int descent = face->size->metrics.descender >> 6;
-    int lineGap = (face->size->metrics.height - (face->size->metrics.ascender - face->size->metrics.descender)) >> 6;
-    int lineHeight = ascent - descent + lineGap;
-    int currentLineWidth = 0;
-    int maxLineWidth = 0;
-    for (size_t i = 0; text[i] != '\0'; ++i) {
-        if (text[i] == '\n') {
-            if (currentLineWidth > maxLineWidth) {
-                maxLineWidth = currentLineWidth;
+    for (int k = 1; k < length; ++k) {
+        // Stops at the terminator too, it is not a continuation byte
+            if ((s[k] & 0xC0) != 0x80) {
+                (*i)++;
+                return 0xFFFD;
             }
-            currentLineWidth = 0;
-            size.height += lineHeight;
+        codepoint = (codepoint << 6) | (s[k] & 0x3F);
+    }
+    // Overlong forms, surrogates and values past Unicode
+        if (codepoint < minimum[length] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+            (*i)++;
+            return 0xFFFD;
+        }
+    *i += length;
+    return codepoint;
+}
+
+// Text Layout Cache
+
+#define TEXT_LAYOUT_CACHE_MAX 1024
+#define TEXT_LAYOUT_FRAMES 120 // Layouts unused for this many frames are dropped
+
+typedef struct {
+    FT_ULong codepoint;
+    int offset;            // Byte offset in the source string, selections are byte ranges
+    float x, y;            // Pen position relative to the text origin, baseline included
+} LayoutGlyph;
+
+typedef struct {
+    FontAtlas* atlas;
+    float fontSize;
+    uint64_t hash;
+    char* text;
+    LayoutGlyph* glyphs;   // Drawable codepoints only, newlines and control bytes are folded into the positions
+    int count;
+    TextSize size;         // Bounding box of the whole string
+    GLfloat* vertices;     // Quads relative to the origin
+    size_t vertexcount;
+    unsigned int version;  // Atlas version the quads were written against, 0 when they must be rebuilt
+    int* shelves;          // Atlas shelves the quads sample, kept warm on every draw
+    int shelfcount;
+    unsigned int frame;    // Last frame the layout was used
+} TextLayout;
+
+typedef struct {
+    TextLayout* entries;
+    int* slots;            // Open addressing table of entry indices, -1 when empty
+    size_t capacity;
+    size_t count;
+    size_t entrycapacity;
+    unsigned int frame;
+    int hits;
+    int misses;
+} TextLayoutCache;
+
+TextLayoutCache textlayoutcache = {0};
+
+static uint64_t TextLayoutHash(FontAtlas* atlas, float fontSize, const char* text, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = Hash64(&atlas, sizeof(FontAtlas*), hash);
+    hash = Hash64(&fontSize, sizeof(float), hash);
+    return Hash64(text, length, hash);
+}
+
+static void TextLayoutRehash(size_t capacity) {
+    free(textlayoutcache.slots);
+    textlayoutcache.slots = malloc(capacity * sizeof(int));
+    memset(textlayoutcache.slots, 0xFF, capacity * sizeof(int));
+    textlayoutcache.capacity = capacity;
+    for (size_t e = 0; e < textlayoutcache.count; ++e) {
+        size_t i = textlayoutcache.entries[e].hash & (capacity - 1);
+        while (textlayoutcache.slots[i] != -1) i = (i + 1) & (capacity - 1);
+        textlayoutcache.slots[i] = e;
+    }
+}
+
+// Drops the layouts built against atlas (any atlas when NULL) that were last used before the given frame
+static void TextLayoutSweep(FontAtlas* atlas, unsigned int before) {
+    size_t kept = 0;
+    for (size_t e = 0; e < textlayoutcache.count; ++e) {
+        TextLayout* layout = &textlayoutcache.entries[e];
+        if ((!atlas || layout->atlas == atlas) && layout->frame < before) {
+            free(layout->text);
+            free(layout->glyphs);
+            free(layout->vertices);
+            free(layout->shelves);
             continue;
         }
-        int codepoint = (unsigned char)text[i];
-        error = FT_Load_Char(face, codepoint, FT_LOAD_DEFAULT);
-        if (error) {
+        textlayoutcache.entries[kept++] = *layout;
+    }
+    if (kept == textlayoutcache.count) return;
+    textlayoutcache.count = kept;
+    TextLayoutRehash(textlayoutcache.capacity);
+}
+
+void TextLayoutFrame(void) {
+    textlayoutcache.frame++;
+    if (textlayoutcache.frame % TEXT_LAYOUT_FRAMES == 0) TextLayoutSweep(NULL, textlayoutcache.frame - TEXT_LAYOUT_FRAMES);
+}
+
+// Decodes and positions every glyph once, kerning included, the atlas only supplies metrics here
+static void TextLayoutBuild(TextLayout* layout) {
+    FontAtlas* atlas = layout->atlas;
+    FT_Face face = atlas->face;
+    float scale = layout->fontSize / atlas->fontSize;
+    int lineHeight = atlas->lineheight * scale;
+    size_t length = strlen(layout->text);
+    layout->glyphs = malloc((length ? length : 1) * sizeof(LayoutGlyph));
+    bool kerning = FT_HAS_KERNING(face);
+    FontAtlasActivate(atlas);
+    float xpos = 0.0f;
+    float ypos = 120.0f * scale;
+    float width = 0.0f;
+    int lines = 1;
+    FT_UInt previous = 0;
+    size_t i = 0;
+    while (i < length) {
+        int offset = i;
+        FT_ULong codepoint = DecodeUTF8(layout->text, &i);
+        if (codepoint == '\n') {
+            if (xpos > width) width = xpos;
+            xpos = 0.0f;
+            ypos += lineHeight;
+            lines++;
+            previous = 0;
             continue;
         }
-        currentLineWidth += slot->advance.x >> 6;
-        if (text[i + 1]) {
-            int nextCodepoint = (unsigned char)text[i + 1];
-            FT_Vector delta;
-            FT_Get_Kerning(face, codepoint, nextCodepoint, FT_KERNING_DEFAULT, &delta);
-            currentLineWidth += delta.x >> 6;
+        if (codepoint < 32) continue;
+        AtlasGlyph* entry = GetFontGlyph(atlas, codepoint);
+        if (kerning) {
+            if (previous && entry->index) {
+                FT_Vector delta;
+                FT_Get_Kerning(face, previous, entry->index, FT_KERNING_DEFAULT, &delta);
+                xpos += (delta.x >> 6) * scale;
+            }
+            previous = entry->index;
         }
+        layout->glyphs[layout->count++] = (LayoutGlyph){codepoint, offset, xpos, ypos};
+        xpos += entry->glyph.xadvance * scale;
     }
-    if (currentLineWidth > maxLineWidth) {
-        maxLineWidth = currentLineWidth;
-    }
-    size.width = maxLineWidth;
-    size.height += lineHeight;
-    return size;
+    if (xpos > width) width = xpos;
+    layout->size = (TextSize){(int)ceilf(width), lines * lineHeight};
 }
 
-void RenderShaderText(ShaderObject obj, Color color, float fontSize) {
-    if (obj.shader.hotreloading) {
-        obj.shader = ShaderHotReload(obj.shader);
-    }
-    // Projection Matrix
-        GLfloat Projection[16], Model[16], View[16];
-        CalculateProjections(obj,Model,Projection,View);
-    // Depth
-        if(obj.is3d) {
-            if(obj.cam.fov > 0.0f){
-                glEnable(GL_DEPTH_TEST);
-                glDepthFunc(GL_LEQUAL);
-                glEnable(GL_CULL_FACE);
-                glCullFace(GL_BACK);
-                glFrontFace(GL_CCW);
-            } else {
-                glEnable(GL_DEPTH_TEST);
-                glDepthFunc(GL_LESS);
-                glEnable(GL_CULL_FACE);
-                glCullFace(GL_FRONT);
-                glFrontFace(GL_CCW);
+// Returns the layout of text at fontSize, built the first time it is seen, the pointer is valid until the next call
+TextLayout* GetTextLayout(Font font, float fontSize, const char* text) {
+    if (!font.face || !text) return NULL;
+    if (fontSize <= 1.0f) fontSize = 1.0f;
+    font = SetFontSize(font, font.fontSize);
+    if (!font.atlas) return NULL;
+    FontAtlas* atlas = font.atlas;
+    uint64_t hash = TextLayoutHash(atlas, fontSize, text, strlen(text));
+    // Lookup
+        if (textlayoutcache.capacity) {
+            size_t mask = textlayoutcache.capacity - 1;
+            for (size_t i = hash & mask; textlayoutcache.slots[i] != -1; i = (i + 1) & mask) {
+                TextLayout* layout = &textlayoutcache.entries[textlayoutcache.slots[i]];
+                if (layout->hash == hash && layout->atlas == atlas && layout->fontSize == fontSize && strcmp(layout->text, text) == 0) {
+                    layout->frame = textlayoutcache.frame;
+                    textlayoutcache.hits++;
+                    return layout;
+                }
             }
         }
-    // Debug
-        if (window.debug.wireframe) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        } else if (window.debug.point) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
-            if(window.debug.pointsize > 0) glPointSize(window.debug.pointsize);
-        } else {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // Miss, stale layouts make room first, then everything not used this frame
+        textlayoutcache.misses++;
+        if (textlayoutcache.count >= TEXT_LAYOUT_CACHE_MAX) TextLayoutSweep(NULL, textlayoutcache.frame);
+        if (textlayoutcache.count >= TEXT_LAYOUT_CACHE_MAX) TextLayoutSweep(NULL, ~0u);
+    // Insert
+        if ((textlayoutcache.count + 1) * 4 > textlayoutcache.capacity * 3) TextLayoutRehash(textlayoutcache.capacity ? textlayoutcache.capacity * 2 : 64);
+        if (textlayoutcache.count == textlayoutcache.entrycapacity) {
+            textlayoutcache.entrycapacity = textlayoutcache.entrycapacity ? textlayoutcache.entrycapacity * 2 : 32;
+            textlayoutcache.entries = realloc(textlayoutcache.entries, textlayoutcache.entrycapacity * sizeof(TextLayout));
         }
+        int index = textlayoutcache.count++;
+        TextLayout* layout = &textlayoutcache.entries[index];
+        *layout = (TextLayout){atlas, fontSize, hash, strdup(text)};
+        layout->frame = textlayoutcache.frame;
+        TextLayoutBuild(layout);
+        size_t mask = textlayoutcache.capacity - 1;
+        size_t i = hash & mask;
+        while (textlayoutcache.slots[i] != -1) i = (i + 1) & mask;
+        textlayoutcache.slots[i] = index;
+    return layout;
+}
+
+TextSize GetTextSize(Font font, float fontSize, const char* text) {
+    TextLayout* layout = GetTextLayout(font, fontSize, text);
+    if (!layout) return (TextSize){0, 0};
+    return layout->size;
+}
+
+void RenderShaderTextElements(ShaderObject obj, GLuint vao, GLsizei count, GLintptr indexoffset, GLint basevertex, Color color, float fontSize) {
+    BatchFlush();
+    if (obj.shader.hotreloading) {
+        obj.shader = ShaderHotReload(obj.shader);
+    }
+    // Model Matrix
+        GLfloat Model[16];
+        CalculateModel(obj, Model);
+        UseFrameUniforms(obj);
+    // Depth and Debug
+        SetRenderState(obj);
     // Bind VAO
-        glBindVertexArray(VAO);
-    // Bind VBO and update with new vertex data
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, obj.size_vertices, obj.vertices);
-    // Bind EBO and update with new index data
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, obj.size_indices, obj.indices);
+        StateBindVertexArray(vao);
     // Use the shader program
-        glUseProgram(obj.shader.Program);
+        StateUseProgram(obj.shader.Program);
     // Set uniforms
-        GLumatrix4fv(obj.shader, "projection", Projection);
-        GLumatrix4fv(obj.shader, "model", Model);
-        GLumatrix4fv(obj.shader, "view", View);
-        GLuint1f(obj.shader, "Size", fontSize);
-        GLuint4f(obj.shader, "Color", color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
-        GLuint1f(obj.shader, "iTime", glfwGetTime());
-        GLuint2f(obj.shader, "iResolution", window.screen_width, window.screen_height);
-        GLuint2f(obj.shader, "iMouse", mouse.x, mouse.y);
+        glUniformMatrix4fv(obj.shader.locations.model, 1, GL_FALSE, Model);
+        glUniform1f(obj.shader.locations.Size, fontSize);
+        glUniform4f(obj.shader.locations.Color, color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
+        SetFrameUniforms(obj.shader);
     // Draw using indices
-        glDrawElements(GL_TRIANGLES, obj.size_indices / sizeof(GLuint), GL_UNSIGNED_INT, 0);
-    // Unbind shader program
-        glUseProgram(0);
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    // Disable Effects
-        if(obj.is3d) {
-            glDisable(GL_CULL_FACE);
-            glDisable(GL_DEPTH_TEST);
-        }
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)indexoffset, basevertex);
 }
 
-void DrawText(int x, int y, Font font, float fontSize, const char* text, Color color) {
-    if (fontSize <= 1.0f) fontSize = 1.0f;
-    if (color.a == 0) color.a = 255;
-    if (!font.face || !font.textureID) return;
-    float scale = fontSize / font.fontSize;
-    font = SetFontSize(font, font.fontSize);
-    glBindTexture(GL_TEXTURE_2D, font.textureID);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    FT_Face face = font.face;
-    int lineHeight = (face->size->metrics.height >> 6) * scale;
-    int ascent = (face->size->metrics.ascender >> 6) * scale;
-    int descent = (face->size->metrics.descender >> 6) * scale;
-    float xpos = (float)x;
-    float ypos = (float)y + (120.0f  * scale);
-    FT_UInt previous = 0;
-    for (size_t i = 0; text[i] != '\0'; ++i) {
-        if (text[i] == '\n') {
-            ypos += lineHeight;
-            xpos = (float)x;
-            previous = 0;
-            continue;
-        }
-        FT_UInt codepoint = (unsigned char)text[i];
-        if (codepoint < 32 || codepoint >= 32 + MAX_GLYPHS) continue;
-        Glyph* glyph = &font.glyphs[codepoint - 32];
-        if (FT_HAS_KERNING(face) && previous) {
-            FT_Vector delta;
-            FT_Get_Kerning(face, previous, codepoint, FT_KERNING_DEFAULT, &delta);
-            xpos += (delta.x >> 6) * scale;
-        }
-        previous = codepoint;
-        float x_start = xpos + glyph->xoff * scale;
-        float y_start = ypos - glyph->yoff * scale;
-        float w = (glyph->x1 - glyph->x0) * scale;
-        float h = (glyph->y1 - glyph->y0) * scale;
-        GLfloat vertices[] = {
-            x_start,     y_start + h, 0.0f, glyph->u0, glyph->v1,
-            x_start + w, y_start + h, 0.0f, glyph->u1, glyph->v1,
-            x_start + w, y_start,     0.0f, glyph->u1, glyph->v0,
-            x_start,     y_start,     0.0f, glyph->u0, glyph->v0
-        };
-        GLuint indices[] = {0, 1, 2, 2, 3, 0};
-        RenderShaderText((ShaderObject){camera, shaderfont, vertices, indices, sizeof(vertices), sizeof(indices)}, color, fontSize);
-        xpos += glyph->xadvance * scale;
+void RenderShaderText(ShaderObject obj, Color color, float fontSize) {
+    // Bind VAO
+        StateBindVertexArray(VAO);
+    // Append vertex and index data to the ring buffers
+        GLintptr vertexoffset = StreamUpload(&streamvertex, obj.vertices, obj.size_vertices, FLOAT_PER_VERTEX * sizeof(GLfloat));
+        GLintptr indexoffset = StreamUpload(&streamindex, obj.indices, obj.size_indices, sizeof(GLuint));
+        if (vaogeneration != streamvertex.generation) ShaderAttributes();
+    RenderShaderTextElements(obj, VAO, obj.size_indices / sizeof(GLuint), indexoffset, vertexoffset / (FLOAT_PER_VERTEX * sizeof(GLfloat)), color, fontSize);
+}
+
+// Text Mesh
+
+typedef struct {
+    GLuint VAO;
+    GLuint VBO;
+    GLuint EBO;
+    GLsizei indexcount;
+    GLintptr indexoffset;
+    GLint basevertex;
+    GLuint texture;
+    float fontSize;
+    FontAtlas* atlas;
+    char* text;            // Kept to release the glyphs pinned by a retained mesh
+} TextMesh;
+
+typedef struct {
+    GLfloat* vertices;
+    GLuint* indices;       // Quad pattern shared by every text draw, see TextGeometryIndices
+    size_t vertexcount;
+    size_t vertexcapacity;
+    size_t quadcapacity;
+    int* shelves;          // Atlas shelves sampled by the last build
+    int shelfcount;
+    int shelfcapacity;
+    bool complete;         // False when a glyph could not be made resident
+} TextGeometry;
+
+static TextGeometry textgeometry = {0};
+
+// Every quad uses the same six indices, so the pattern is written once and only extended
+static void TextGeometryIndices(size_t quads) {
+    if (quads <= textgeometry.quadcapacity) return;
+    size_t capacity = textgeometry.quadcapacity ? textgeometry.quadcapacity : 64;
+    while (capacity < quads) capacity *= 2;
+    textgeometry.indices = realloc(textgeometry.indices, capacity * 6 * sizeof(GLuint));
+    for (size_t q = textgeometry.quadcapacity; q < capacity; ++q) {
+        GLuint base = q * 4;
+        GLuint* out = textgeometry.indices + q * 6;
+        out[0] = base + 0;
+        out[1] = base + 1;
+        out[2] = base + 2;
+        out[3] = base + 2;
+        out[4] = base + 3;
+        out[5] = base + 0;
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_BLEND);
+    textgeometry.quadcapacity = capacity;
 }
 
-void DrawTextEditor(int x, int y, Font font, float fontSize, const char* text, Color color, int cursorStart, int cursorEnd, Shader shaderfont, Shader shaderfontcursor) {
-    if (fontSize <= 1.0f) fontSize = 1.0f;
-    if (color.a == 0) color.a = 255;
-    if (!font.face || !font.textureID) return;
-    float scale = fontSize / font.fontSize;
-    font = SetFontSize(font, font.fontSize);
-    glBindTexture(GL_TEXTURE_2D, font.textureID);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    FT_Face face = font.face;
-    int lineHeight = (face->size->metrics.height >> 6) * scale;
-    int ascent = (face->size->metrics.ascender >> 6) * scale;
-    int descent = (face->size->metrics.descender >> 6) * scale;
-    float xpos = (float)x;
-    float ypos = (float)y + (120.0f  * scale);
-    FT_UInt previous = 0;
-    for (size_t i = 0; text[i] != '\0'; ++i) {
-        if (text[i] == '\n') {
-            ypos += lineHeight;
-            xpos = (float)x;
-            previous = 0;
+static void TextGeometryShelf(int shelf) {
+    for (int s = 0; s < textgeometry.shelfcount; ++s) {
+        if (textgeometry.shelves[s] == shelf) return;
+    }
+    if (textgeometry.shelfcount == textgeometry.shelfcapacity) {
+        textgeometry.shelfcapacity = textgeometry.shelfcapacity ? textgeometry.shelfcapacity * 2 : 16;
+        textgeometry.shelves = realloc(textgeometry.shelves, textgeometry.shelfcapacity * sizeof(int));
+    }
+    textgeometry.shelves[textgeometry.shelfcount++] = shelf;
+}
+
+// Writes the quads of layout into textgeometry relative to the origin, keeping only the glyphs whose selection state matches when filter is set
+static void TextGeometryBuild(TextLayout* layout, int selectStart, int selectEnd, bool filter, bool selected) {
+    FontAtlas* atlas = layout->atlas;
+    float scale = layout->fontSize / atlas->fontSize;
+    textgeometry.vertexcount = 0;
+    textgeometry.shelfcount = 0;
+    textgeometry.complete = true;
+    if ((size_t)layout->count * 4 > textgeometry.vertexcapacity) {
+        textgeometry.vertexcapacity = layout->count * 4;
+        textgeometry.vertices = realloc(textgeometry.vertices, textgeometry.vertexcapacity * FLOAT_PER_VERTEX * sizeof(GLfloat));
+    }
+    atlas->tick++;
+    int retired = atlas->retiredcount;
+    for (int g = 0; g < layout->count; ++g) {
+        LayoutGlyph* item = &layout->glyphs[g];
+        bool isSelected = (selectStart >= 0 && item->offset >= selectStart && item->offset <= selectEnd);
+        if (filter && isSelected != selected) continue;
+        AtlasGlyph* entry = GetFontGlyph(atlas, item->codepoint);
+        if (entry->shelf < 0) {
+            if (!entry->missing) textgeometry.complete = false;
             continue;
         }
-        FT_UInt codepoint = (unsigned char)text[i];
-        if (codepoint < 32 || codepoint >= 32 + MAX_GLYPHS) continue;
-        Glyph* glyph = &font.glyphs[codepoint - 32];
-        if (FT_HAS_KERNING(face) && previous) {
-            FT_Vector delta;
-            FT_Get_Kerning(face, previous, codepoint, FT_KERNING_DEFAULT, &delta);
-            xpos += (delta.x >> 6) * scale;
-        }
-        previous = codepoint;
-        float x_start = xpos + glyph->xoff * scale;
-        float y_start = ypos - glyph->yoff * scale;
+        TextGeometryShelf(entry->shelf);
+        Glyph* glyph = &entry->glyph;
+        float x_start = item->x + glyph->xoff * scale;
+        float y_start = item->y - glyph->yoff * scale;
         float w = (glyph->x1 - glyph->x0) * scale;
         float h = (glyph->y1 - glyph->y0) * scale;
         GLfloat vertices[] = {
@@ -402,33 +821,173 @@ void DrawTextEditor(int x, int y, Font font, float fontSize, const char* text, C
             x_start + w, y_start,     0.0f, glyph->u1, glyph->v0,
             x_start,     y_start,     0.0f, glyph->u0, glyph->v0
         };
-        GLuint indices[] = {0, 1, 2, 2, 3, 0};
-        bool isSelected = (i >= cursorStart && i <= cursorEnd);
-        if (isSelected) {
-            RenderShaderText((ShaderObject){camera, shaderfontcursor, vertices, indices, sizeof(vertices), sizeof(indices)}, color, fontSize);
-        } else {
-            RenderShaderText((ShaderObject){camera, shaderfont, vertices, indices, sizeof(vertices), sizeof(indices)}, color, fontSize);
+        memcpy(textgeometry.vertices + textgeometry.vertexcount * FLOAT_PER_VERTEX, vertices, sizeof(vertices));
+        textgeometry.vertexcount += 4;
+    }
+    // The atlas grew while laying out, the texture coordinates written so far are stale
+    if (atlas->retiredcount != retired) TextGeometryBuild(layout, selectStart, selectEnd, filter, selected);
+}
+
+// Reuses the quads of layout until the atlas moves or drops glyphs, a hit only keeps their shelves warm
+static void TextLayoutVertices(TextLayout* layout) {
+    FontAtlas* atlas = layout->atlas;
+    if (layout->version == atlas->version) {
+        atlas->tick++;
+        for (int s = 0; s < layout->shelfcount; ++s) {
+            atlas->shelves[layout->shelves[s]].tick = atlas->tick;
         }
-        xpos += glyph->xadvance * scale;
+        return;
+    }
+    TextGeometryBuild(layout, -1, -1, false, false);
+    layout->vertexcount = textgeometry.vertexcount;
+    layout->vertices = realloc(layout->vertices, (layout->vertexcount ? layout->vertexcount : 1) * FLOAT_PER_VERTEX * sizeof(GLfloat));
+    memcpy(layout->vertices, textgeometry.vertices, layout->vertexcount * FLOAT_PER_VERTEX * sizeof(GLfloat));
+    layout->shelfcount = textgeometry.shelfcount;
+    layout->shelves = realloc(layout->shelves, (layout->shelfcount ? layout->shelfcount : 1) * sizeof(int));
+    memcpy(layout->shelves, textgeometry.shelves, layout->shelfcount * sizeof(int));
+    layout->version = textgeometry.complete ? atlas->version : 0;
+}
+
+// Retained meshes pin their glyphs so the atlas never evicts them
+static void TextGeometryPin(FontAtlas* atlas, const char* text, int delta) {
+    size_t i = 0;
+    while (text[i]) {
+        FT_ULong codepoint = DecodeUTF8(text, &i);
+        if (codepoint < 32) continue;
+        AtlasGlyph* entry = FontAtlasSlot(atlas, codepoint);
+        if (!entry->loaded) continue;
+        entry->pins += delta;
+        if (entry->pins < 0) entry->pins = 0;
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_BLEND);
+}
+
+static void TextMeshUpload(TextMesh* mesh, GLenum usage) {
+    if (!mesh->VAO) {
+        glGenVertexArrays(1, &mesh->VAO);
+        glGenBuffers(1, &mesh->VBO);
+        glGenBuffers(1, &mesh->EBO);
+        StateBindVertexArray(mesh->VAO);
+        StateBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    } else {
+        StateBindVertexArray(mesh->VAO);
+        StateBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    }
+    size_t quads = textgeometry.vertexcount / 4;
+    TextGeometryIndices(quads);
+    glBufferData(GL_ARRAY_BUFFER, textgeometry.vertexcount * FLOAT_PER_VERTEX * sizeof(GLfloat), textgeometry.vertices, usage);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, quads * 6 * sizeof(GLuint), textgeometry.indices, usage);
+    mesh->indexcount = quads * 6;
+}
+
+// Streams quads through the shared ring buffers instead of a mesh of their own
+static TextMesh TextMeshStream(FontAtlas* atlas, const GLfloat* vertices, size_t vertexcount, float fontSize) {
+    TextMesh mesh = {VAO};
+    size_t quads = vertexcount / 4;
+    TextGeometryIndices(quads);
+    StateBindVertexArray(VAO);
+    GLintptr vertexoffset = StreamUpload(&streamvertex, vertices, vertexcount * FLOAT_PER_VERTEX * sizeof(GLfloat), FLOAT_PER_VERTEX * sizeof(GLfloat));
+    mesh.indexoffset = StreamUpload(&streamindex, textgeometry.indices, quads * 6 * sizeof(GLuint), sizeof(GLuint));
+    if (vaogeneration != streamvertex.generation) ShaderAttributes();
+    mesh.basevertex = vertexoffset / (FLOAT_PER_VERTEX * sizeof(GLfloat));
+    mesh.indexcount = quads * 6;
+    mesh.texture = atlas->textureID;
+    mesh.fontSize = fontSize;
+    return mesh;
+}
+
+static void TextMeshRender(TextMesh mesh, Shader shader, float x, float y, Color color) {
+    if (mesh.indexcount == 0) return;
+    StateBindTexture(mesh.texture);
+    StateEnable(GL_BLEND, true);
+    StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ShaderObject obj = {camera, shader};
+    obj.transform.position = (Vec3){x, y, 0.0f};
+    RenderShaderTextElements(obj, mesh.VAO, mesh.indexcount, mesh.indexoffset, mesh.basevertex, color, mesh.fontSize);
+}
+
+TextMesh LoadTextMesh(Font font, float fontSize, const char* text) {
+    TextMesh mesh = {0};
+    TextLayout* layout = GetTextLayout(font, fontSize, text);
+    if (!layout) return mesh;
+    TextGeometryBuild(layout, -1, -1, false, false);
+    TextMeshUpload(&mesh, GL_STATIC_DRAW);
+    TextGeometryPin(layout->atlas, text, 1);
+    mesh.texture = layout->atlas->textureID;
+    mesh.fontSize = layout->fontSize;
+    mesh.atlas = layout->atlas;
+    mesh.text = strdup(text);
+    return mesh;
+}
+
+void DrawTextMesh(TextMesh mesh, int x, int y, Color color) {
+    if (color.a == 0) color.a = 255;
+    TextMeshRender(mesh, mesh.atlas && mesh.atlas->sdf ? shaderfontsdf : shaderfont, x, y, color);
+}
+
+void DrawTextMeshShader(TextMesh mesh, int x, int y, Color color, Shader shader) {
+    if (color.a == 0) color.a = 255;
+    TextMeshRender(mesh, shader, x, y, color);
+}
+
+void UnloadTextMesh(TextMesh mesh) {
+    if (mesh.atlas && mesh.text) TextGeometryPin(mesh.atlas, mesh.text, -1);
+    free(mesh.text);
+    StateDeleteVertexArray(mesh.VAO);
+    StateDeleteBuffer(mesh.VBO);
+    StateDeleteBuffer(mesh.EBO);
+}
+
+void DrawText(int x, int y, Font font, float fontSize, const char* text, Color color) {
+    if (color.a == 0) color.a = 255;
+    bool nearest = font.nearest;
+    TextLayout* layout = GetTextLayout(font, fontSize, text);
+    if (!layout) return;
+    FontAtlas* atlas = layout->atlas;
+    SetFontAtlasFilter(atlas, nearest);
+    TextLayoutVertices(layout);
+    TextMeshRender(TextMeshStream(atlas, layout->vertices, layout->vertexcount, layout->fontSize), atlas->sdf ? shaderfontsdf : shaderfont, x, y, color);
+}
+
+void DrawTextEditor(int x, int y, Font font, float fontSize, const char* text, Color color, int cursorStart, int cursorEnd, Shader shaderfont, Shader shaderfontcursor) {
+    if (color.a == 0) color.a = 255;
+    bool nearest = font.nearest;
+    TextLayout* layout = GetTextLayout(font, fontSize, text);
+    if (!layout) return;
+    FontAtlas* atlas = layout->atlas;
+    SetFontAtlasFilter(atlas, nearest);
+    // Unselected glyphs
+        TextGeometryBuild(layout, cursorStart, cursorEnd, true, false);
+        TextMeshRender(TextMeshStream(atlas, textgeometry.vertices, textgeometry.vertexcount, layout->fontSize), shaderfont, x, y, color);
+    // Selected glyphs
+        TextGeometryBuild(layout, cursorStart, cursorEnd, true, true);
+        TextMeshRender(TextMeshStream(atlas, textgeometry.vertices, textgeometry.vertexcount, layout->fontSize), shaderfontcursor, x, y, color);
 }
 
 void FreeFontCache() {
-    FontCacheNode* node = fontCache;
-    while (node) {
-        FontCacheNode* next = node->next;
-        if (node->font.textureID) {
-            glDeleteTextures(1, &node->font.textureID);
-            node->font.textureID = 0;
-        }
-        if (node->font.atlasData) {
-            free(node->font.atlasData);
-            node->font.atlasData = NULL;
+    // Atlases first, their sizes belong to the faces
+        for (size_t i = 0; i < fontregistry.capacity; ++i) {
+            if (fontregistry.atlases[i]) UnloadFontAtlas(fontregistry.atlases[i]);
         }
-        free(node);
-        node = next;
+        free(fontregistry.atlases);
+    for (int i = 0; i < fontregistry.facecount; ++i) {
+        FT_Done_Face(fontregistry.faces[i].face);
+        free(fontregistry.faces[i].path);
     }
-    fontCache = NULL;
+    free(fontregistry.faces);
+    if (fontregistry.library) FT_Done_FreeType(fontregistry.library);
+    fontregistry = (FontRegistry){0};
+    TextLayoutSweep(NULL, ~0u);
+    free(textlayoutcache.entries);
+    free(textlayoutcache.slots);
+    textlayoutcache = (TextLayoutCache){0};
+    free(textgeometry.vertices);
+    free(textgeometry.indices);
+    free(textgeometry.shelves);
+    textgeometry = (TextGeometry){0};
 }
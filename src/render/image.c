@@ -1,86 +1,714 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <strings.h>
 
 typedef struct {
     GLuint raw;         
     unsigned char* data;
     int width, height;  
     int channels;
+    float u0, v0, u1, v1; // Sub-rect inside raw for atlas images, all zero samples the whole texture
 } Img;
 
 typedef struct {
     const char *filename;
     bool nearest;
+    bool mipmap;    // Full mip chain with trilinear minification
+    bool compress;  // Let the driver compress to DXT5 when S3TC is available, a quarter of the VRAM
+    bool cache;     // Keep the processed texture in imagecache.dir and load it from there next time
 } ImgInfo;
 
+static void ImageFilter(bool nearest, int levels) {
+    glTexOpt(nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    if (levels > 1) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, nearest ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+}
+
+// Mipmaps
+
+#define IMAGE_MAX_LEVELS 16
+
+typedef struct {
+    unsigned char* pixels[IMAGE_MAX_LEVELS];
+    int width[IMAGE_MAX_LEVELS];
+    int height[IMAGE_MAX_LEVELS];
+    int levels;
+} ImageLevels;
+
+// Box filters RGBA levels down to 1x1. Sizes halve rounding down like GL expects, so on an odd edge the
+// last output texel averages the last three source texels instead of dropping one
+static void ImageMipmaps(ImageLevels* chain) {
+    while (chain->levels < IMAGE_MAX_LEVELS) {
+        int l = chain->levels - 1;
+        int sw = chain->width[l];
+        int sh = chain->height[l];
+        if (sw == 1 && sh == 1) break;
+        int dw = sw > 1 ? sw / 2 : 1;
+        int dh = sh > 1 ? sh / 2 : 1;
+        const unsigned char* src = chain->pixels[l];
+        unsigned char* dst = malloc((size_t)dw * dh * 4);
+        for (int y = 0; y < dh; ++y) {
+            int y0 = sh > 1 ? y * 2 : 0;
+            int y1 = y == dh - 1 ? sh : y0 + 2; // Exclusive
+            for (int x = 0; x < dw; ++x) {
+                int x0 = sw > 1 ? x * 2 : 0;
+                int x1 = x == dw - 1 ? sw : x0 + 2;
+                int count = (y1 - y0) * (x1 - x0);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = 0;
+                    for (int sy = y0; sy < y1; ++sy) {
+                        for (int sx = x0; sx < x1; ++sx) sum += src[((size_t)sy * sw + sx) * 4 + c];
+                    }
+                    dst[((size_t)y * dw + x) * 4 + c] = (sum + count / 2) / count;
+                }
+            }
+        }
+        chain->pixels[chain->levels] = dst;
+        chain->width[chain->levels] = dw;
+        chain->height[chain->levels] = dh;
+        chain->levels++;
+    }
+}
+
+// Texture Cache Files
+
+#define IMAGE_CACHE_MAGIC 0x58455447 // "GTEX"
+#define IMAGE_CACHE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourcesize;     // Source file size and time, a mismatch rebuilds the entry
+    int64_t sourcetime;
+    uint32_t width, height;
+    uint32_t format;         // GL_RGBA8, or the compressed format the driver produced
+    uint32_t levels;
+} ImageCacheHeader;
+
+typedef struct {
+    uint32_t width, height;
+    uint32_t size;
+    uint32_t offset;         // From the start of the file
+} ImageCacheLevel;
+
+typedef struct {
+    const char* dir;
+    int hits;
+    int misses;
+} ImageCache;
+
+ImageCache imagecache = {".cache", 0, 0};
+
+static char* ImageCachePath(ImgInfo info) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = Hash64(info.filename, strlen(info.filename), hash);
+    hash = Hash64(&info.mipmap, sizeof(bool), hash);
+    hash = Hash64(&info.compress, sizeof(bool), hash);
+    char* path = malloc(strlen(imagecache.dir) + 32);
+    sprintf(path, "%s/%016llx.gtex", imagecache.dir, (unsigned long long)hash);
+    return path;
+}
+
+// Bytes per 4x4 block of the S3TC formats the driver may have picked, 0 for anything else
+static uint32_t ImageCacheBlockSize(uint32_t format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return 16;
+        default: return 0;
+    }
+}
+
+// Maps the file and uploads every level straight from the mapping, no decode and no copy
+static bool ImageCacheLoad(const char* path, struct stat* source, ImgInfo info, Img* img) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat file;
+    if (fstat(fd, &file) != 0 || file.st_size < (off_t)sizeof(ImageCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    unsigned char* data = mmap(NULL, file.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    ImageCacheHeader* header = (ImageCacheHeader*)data;
+    ImageCacheLevel* levels = (ImageCacheLevel*)(data + sizeof(ImageCacheHeader));
+    bool compressed = header->format != GL_RGBA8;
+    // Stale or foreign entries are rebuilt
+        bool valid = header->magic == IMAGE_CACHE_MAGIC && header->version == IMAGE_CACHE_VERSION;
+        valid = valid && header->sourcesize == (uint64_t)source->st_size && header->sourcetime == (int64_t)source->st_mtime;
+        valid = valid && header->levels > 0 && header->levels <= IMAGE_MAX_LEVELS;
+        valid = valid && sizeof(ImageCacheHeader) + header->levels * sizeof(ImageCacheLevel) <= (size_t)file.st_size;
+        valid = valid && (!compressed || GLEW_EXT_texture_compression_s3tc);
+        valid = valid && header->width > 0 && header->height > 0;
+        // Every level must follow the mip chain and hold exactly the bytes its size needs, or GL reads past the mapping
+            uint32_t width = header->width, height = header->height;
+            for (uint32_t l = 0; valid && l < header->levels; ++l) {
+                uint64_t bytes = (uint64_t)width * height * 4;
+                if (compressed) bytes = (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * ImageCacheBlockSize(header->format);
+                valid = levels[l].width == width && levels[l].height == height && bytes && levels[l].size == bytes;
+                valid = valid && (uint64_t)levels[l].offset + levels[l].size <= (uint64_t)file.st_size;
+                width = width > 1 ? width / 2 : 1;
+                height = height > 1 ? height / 2 : 1;
+            }
+    if (valid) {
+        glGenTextures(1, &img->raw);
+        StateBindTexture(img->raw);
+        for (uint32_t l = 0; l < header->levels; ++l) {
+            if (compressed) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, l, header->format, levels[l].width, levels[l].height, 0, levels[l].size, data + levels[l].offset);
+            } else {
+                glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, levels[l].width, levels[l].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data + levels[l].offset);
+            }
+        }
+        ImageFilter(info.nearest, header->levels);
+        img->width = header->width;
+        img->height = header->height;
+        img->channels = 4;
+    }
+    munmap(data, file.st_size);
+    return valid;
+}
+
+// Writes the bound texture back out, compressed levels are read from the driver as it encoded them
+static void ImageCacheStore(const char* path, struct stat* source, ImageLevels* chain, bool compressed) {
+    // Written next to the final path and renamed over it, a reader never maps a half written file
+        mkdir(imagecache.dir, 0755);
+        char temp[PATH_MAX];
+        snprintf(temp, sizeof(temp), "%s.%d.tmp", path, (int)getpid());
+        FILE* file = fopen(temp, "wb");
+        if (!file) {
+            printf("Failed to write texture cache %s\n", path);
+            return;
+        }
+    ImageCacheHeader header = {IMAGE_CACHE_MAGIC, IMAGE_CACHE_VERSION, source->st_size, source->st_mtime, chain->width[0], chain->height[0], GL_RGBA8, chain->levels};
+    ImageCacheLevel levels[IMAGE_MAX_LEVELS] = {0};
+    unsigned char* data[IMAGE_MAX_LEVELS] = {0};
+    if (compressed) {
+        GLint format;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+        header.format = format;
+    }
+    uint32_t offset = sizeof(ImageCacheHeader) + chain->levels * sizeof(ImageCacheLevel);
+    for (int l = 0; l < chain->levels; ++l) {
+        GLint size = chain->width[l] * chain->height[l] * 4;
+        data[l] = chain->pixels[l];
+        if (compressed) {
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+            data[l] = malloc(size);
+            glGetCompressedTexImage(GL_TEXTURE_2D, l, data[l]);
+        }
+        levels[l] = (ImageCacheLevel){chain->width[l], chain->height[l], size, offset};
+        offset += size;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(levels, sizeof(ImageCacheLevel), chain->levels, file) == (size_t)chain->levels;
+    for (int l = 0; l < chain->levels; ++l) {
+        written = written && fwrite(data[l], 1, levels[l].size, file) == levels[l].size;
+        if (compressed) free(data[l]);
+    }
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temp, path) != 0) {
+        printf("Failed to write texture cache %s\n", path);
+        unlink(temp);
+    }
+}
+
 Img LoadImage(ImgInfo info) {
-    Img img;
+    Img img = {0};
+    // Processed copy from an earlier run
+        struct stat source;
+        char* cachepath = NULL;
+        if (info.cache && stat(info.filename, &source) == 0) {
+            cachepath = ImageCachePath(info);
+            if (ImageCacheLoad(cachepath, &source, info, &img)) {
+                imagecache.hits++;
+                free(cachepath);
+                return img;
+            }
+            imagecache.misses++;
+        }
     stbi_set_flip_vertically_on_load(true);
     img.data = stbi_load(info.filename, &img.width, &img.height, &img.channels, STBI_rgb_alpha);
     if (img.data == NULL) {
         img.raw = 0;
+        free(cachepath);
         return img;
     }
+    ImageLevels chain = {{img.data}, {img.width}, {img.height}, 1};
+    if (info.mipmap) ImageMipmaps(&chain);
+    bool compressed = info.compress && GLEW_EXT_texture_compression_s3tc;
     glGenTextures(1, &img.raw);
-    glBindTexture(GL_TEXTURE_2D, img.raw);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width, img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data);
-    glTexOpt(info.nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    StateBindTexture(img.raw);
+    for (int l = 0; l < chain.levels; ++l) {
+        glTexImage2D(GL_TEXTURE_2D, l, compressed ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA8, chain.width[l], chain.height[l], 0, GL_RGBA, GL_UNSIGNED_BYTE, chain.pixels[l]);
+    }
+    ImageFilter(info.nearest, chain.levels);
+    if (cachepath) ImageCacheStore(cachepath, &source, &chain, compressed);
+    StateBindTexture(0);
+    for (int l = 1; l < chain.levels; ++l) {
+        free(chain.pixels[l]);
+    }
     stbi_image_free(img.data);
     img.data = NULL;
+    free(cachepath);
     return img;
 }
 
-void BindImg(Img image){
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindTexture(GL_TEXTURE_2D, image.raw);
+// Async Image Loading
+
+#define IMAGE_WORKERS 4
+#define IMAGE_UPLOAD_BUDGET (4 * 1024 * 1024)          // Bytes streamed into textures per frame
+#define IMAGE_PLACEHOLDER (Color){128, 128, 128, 255}  // Drawn until the real pixels are in
+
+#define IMAGE_QUEUED   0
+#define IMAGE_DECODING 1
+#define IMAGE_DECODED  2
+#define IMAGE_FAILED   3
+
+typedef struct {
+    char* filename;
+    GLuint texture;
+    bool nearest;
+    bool mipmap;
+    unsigned char* data;
+    int width, height;
+    int row;               // Rows already streamed into the texture
+    int state;             // Written by the workers under the loader lock
+} ImageJob;
+
+typedef struct {
+    pthread_t workers[IMAGE_WORKERS];
+    int workercount;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stop;
+    ImageJob** jobs;       // Only the GL thread adds or removes jobs, always under the lock
+    int count;
+    int capacity;
+    size_t budget;
+} ImageLoader;
+
+ImageLoader imageloader = {.lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .budget = IMAGE_UPLOAD_BUDGET};
+
+// Decodes queued files, the GL thread streams the results in ImageFrame
+static void* ImageWorker(void* arg) {
+    stbi_set_flip_vertically_on_load_thread(true);
+    pthread_mutex_lock(&imageloader.lock);
+    while (!imageloader.stop) {
+        ImageJob* job = NULL;
+        for (int i = 0; i < imageloader.count; ++i) {
+            if (imageloader.jobs[i]->state == IMAGE_QUEUED) {
+                job = imageloader.jobs[i];
+                break;
+            }
+        }
+        if (!job) {
+            pthread_cond_wait(&imageloader.wake, &imageloader.lock);
+            continue;
+        }
+        job->state = IMAGE_DECODING;
+        pthread_mutex_unlock(&imageloader.lock);
+        int width, height, channels;
+        unsigned char* data = stbi_load(job->filename, &width, &height, &channels, STBI_rgb_alpha);
+        pthread_mutex_lock(&imageloader.lock);
+        job->data = data;
+        job->width = data ? width : 0;
+        job->height = data ? height : 0;
+        job->state = data ? IMAGE_DECODED : IMAGE_FAILED;
+    }
+    pthread_mutex_unlock(&imageloader.lock);
+    return NULL;
 }
 
-void DrawImage(Img image, float x, float y, float width, float height, GLfloat angle) {
-    BindImg(image);
-    Rect((RectObject){
-        { x, y + height, 0.0f },         // Bottom Left
-        { x + width, y + height, 0.0f }, // Bottom Right
-        { x, y, 0.0f },                  // Top Left
-        { x + width, y, 0.0f },          // Top Right
-        shaderdefault,                   // Shader
-        camera,                          // Camera
-    });
-    UnbindTexture();
+// Returns at once, image.raw shows IMAGE_PLACEHOLDER until the decoded pixels are uploaded
+// Rows are streamed as plain RGBA, so ImgInfo.compress and ImgInfo.cache only apply to LoadImage
+Img LoadImageAsync(ImgInfo info) {
+    Img img = {0};
+    // The header alone gives the size, so layout code can use it right away
+        if (!stbi_info(info.filename, &img.width, &img.height, &img.channels)) {
+            printf("Failed to load image %s\n", info.filename);
+            return img;
+        }
+    glGenTextures(1, &img.raw);
+    ImageJob* job = calloc(1, sizeof(ImageJob));
+    job->filename = strdup(info.filename);
+    job->texture = img.raw;
+    job->nearest = info.nearest;
+    job->mipmap = info.mipmap;
+    job->state = IMAGE_QUEUED;
+    pthread_mutex_lock(&imageloader.lock);
+    // Workers start with the first request
+        while (imageloader.workercount < IMAGE_WORKERS) {
+            if (pthread_create(&imageloader.workers[imageloader.workercount], NULL, ImageWorker, NULL) != 0) break;
+            imageloader.workercount++;
+        }
+    if (imageloader.count == imageloader.capacity) {
+        imageloader.capacity = imageloader.capacity ? imageloader.capacity * 2 : 32;
+        imageloader.jobs = realloc(imageloader.jobs, imageloader.capacity * sizeof(ImageJob*));
+    }
+    imageloader.jobs[imageloader.count++] = job;
+    pthread_cond_signal(&imageloader.wake);
+    pthread_mutex_unlock(&imageloader.lock);
+    if (imageloader.workercount == 0) printf("Failed to start image workers, %s stays a placeholder\n", info.filename);
+    return img;
+}
+
+// Jobs leave the list once their texture is complete, so only the GL thread's own view is needed here
+static bool ImagePending(GLuint texture) {
+    for (int i = 0; i < imageloader.count; ++i) {
+        if (imageloader.jobs[i]->texture == texture) return true;
+    }
+    return false;
+}
+
+bool ImageReady(Img image) {
+    return image.raw && !ImagePending(image.raw);
+}
+
+static GLuint ImageTexture(Img image) {
+    if (imageloader.count && ImagePending(image.raw)) return GetCachedTexture(IMAGE_PLACEHOLDER, false, false, NULL, 0, 0);
+    return image.raw;
+}
+
+static void ImageJobFree(ImageJob* job) {
+    stbi_image_free(job->data);
+    free(job->filename);
+    free(job);
+}
+
+// Streams decoded rows through a pixel unpack buffer, at most imageloader.budget bytes per frame
+void ImageFrame(void) {
+    if (imageloader.count == 0) return;
+    size_t budget = imageloader.budget;
+    bool uploaded = false;
+    int i = 0;
+    while (i < imageloader.count) {
+        ImageJob* job = imageloader.jobs[i];
+        pthread_mutex_lock(&imageloader.lock);
+        int state = job->state;
+        pthread_mutex_unlock(&imageloader.lock);
+        if (state == IMAGE_FAILED) {
+            // Keep the handle drawable, it just never leaves the placeholder
+                printf("Failed to load image %s\n", job->filename);
+                unsigned char pixels[] = {IMAGE_PLACEHOLDER.r, IMAGE_PLACEHOLDER.g, IMAGE_PLACEHOLDER.b, IMAGE_PLACEHOLDER.a};
+                StateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                StateBindTexture(job->texture);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+                glTexOpt(GL_NEAREST, GL_CLAMP_TO_EDGE);
+                job->row = job->height;
+        } else if (state == IMAGE_DECODED && budget > 0) {
+            size_t rowbytes = (size_t)job->width * 4;
+            if (job->row == 0) {
+                // Storage first, with no unpack buffer bound the NULL pointer means no data
+                    StateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    StateBindTexture(job->texture);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, job->width, job->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                    ImageFilter(job->nearest, 1);
+            }
+            if (!streamunpack.buffer) StreamInit(&streamunpack, GL_PIXEL_UNPACK_BUFFER, imageloader.budget);
+            // A row wider than the budget still goes through on its own
+                int rows = budget / rowbytes;
+                if (rows < 1) rows = 1;
+                if (rows > job->height - job->row) rows = job->height - job->row;
+            GLintptr offset = StreamUpload(&streamunpack, job->data + job->row * rowbytes, rows * rowbytes, 4);
+            StateBindTexture(job->texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->row, job->width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void*)offset);
+            job->row += rows;
+            budget = rows * rowbytes >= budget ? 0 : budget - rows * rowbytes;
+            uploaded = true;
+            // The chain is built on the GPU once the last row is in
+                if (job->mipmap && job->row >= job->height) {
+                    int levels = 1;
+                    while ((job->width >> levels) || (job->height >> levels)) levels++;
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                    ImageFilter(job->nearest, levels);
+                }
+        }
+        if ((state == IMAGE_FAILED || state == IMAGE_DECODED) && job->row >= job->height) {
+            pthread_mutex_lock(&imageloader.lock);
+            imageloader.jobs[i] = imageloader.jobs[--imageloader.count];
+            pthread_mutex_unlock(&imageloader.lock);
+            ImageJobFree(job);
+            continue;
+        }
+        i++;
+    }
+    // Later glTexImage2D calls pass client memory
+        if (uploaded) StateBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void ImageTerminate(void) {
+    pthread_mutex_lock(&imageloader.lock);
+    imageloader.stop = true;
+    pthread_cond_broadcast(&imageloader.wake);
+    pthread_mutex_unlock(&imageloader.lock);
+    for (int i = 0; i < imageloader.workercount; ++i) {
+        pthread_join(imageloader.workers[i], NULL);
+    }
+    for (int i = 0; i < imageloader.count; ++i) {
+        ImageJobFree(imageloader.jobs[i]);
+    }
+    free(imageloader.jobs);
+    imageloader.jobs = NULL;
+    imageloader.count = 0;
+    imageloader.capacity = 0;
+    imageloader.workercount = 0;
+    imageloader.stop = false;
+    StreamTerminate(&streamunpack);
+}
+
+void BindImg(Img image){
+    StateEnable(GL_BLEND, true);
+    StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    StateBindTexture(ImageTexture(image));
 }
 
 void DrawImageShader(Img image, float x, float y, float width, float height, GLfloat angle, Shader shader) {
-    BindImg(image);
-    Rect((RectObject){
+    if (image.u1 == 0.0f && image.v1 == 0.0f) {
+        image.u1 = 1.0f;
+        image.v1 = 1.0f;
+    }
+    BatchRect((RectObject){
         { x, y + height, 0.0f },         // Bottom Left
         { x + width, y + height, 0.0f }, // Bottom Right
         { x, y, 0.0f },                  // Top Left
         { x + width, y, 0.0f },          // Top Right
-        shaderdefault,                   // Shader
+        shader,                          // Shader
         camera,                          // Camera
-    });
-    UnbindTexture();
+    }, ImageTexture(image), (Color){255, 255, 255, 255}, image.u0, image.v0, image.u1, image.v1);
+}
+
+void DrawImage(Img image, float x, float y, float width, float height, GLfloat angle) {
+    DrawImageShader(image, x, y, width, height, angle, shaderdefault);
 }
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
+// Async Capture
+
+#define CAPTURE_SLOTS 3   // Readbacks in flight, mapped a frame or two after they were issued
+#define CAPTURE_WORKERS 2
+
+typedef struct {
+    GLuint pbo;
+    GLsizeiptr size;
+    GLsync fence;         // NULL while the slot is free
+    int serial;           // Issue order, the oldest slot is recycled first
+    int width, height;
+    char* filename;
+} CaptureSlot;
+
+typedef struct CaptureJob {
+    unsigned char* pixels;
+    int width, height;
+    char* filename;
+    struct CaptureJob* next;
+} CaptureJob;
+
+typedef struct {
+    CaptureSlot slots[CAPTURE_SLOTS];
+    pthread_t workers[CAPTURE_WORKERS];
+    int workercount;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stop;
+    CaptureJob* head;     // Encode queue, oldest first
+    CaptureJob* tail;
+    int pending;          // Frames read back but not written yet
+    char* pattern;        // printf pattern of a running recording, NULL when idle
+    int frame;
+    int captured;
+} Capture;
+
+Capture capture = {.lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER};
+
+// Flips rows in place and encodes by extension: png, jpg, bmp, tga, anything else is written raw
+static void CaptureWrite(CaptureJob* job) {
+    size_t stride = (size_t)job->width * 4;
+    unsigned char* row = malloc(stride);
+    for (int y = 0; y < job->height / 2; ++y) {
+        unsigned char* top = job->pixels + y * stride;
+        unsigned char* bottom = job->pixels + (job->height - 1 - y) * stride;
+        memcpy(row, top, stride);
+        memcpy(top, bottom, stride);
+        memcpy(bottom, row, stride);
+    }
+    free(row);
+    const char* extension = strrchr(job->filename, '.');
+    extension = extension ? extension + 1 : "";
+    int written;
+    if (strcasecmp(extension, "png") == 0) {
+        written = stbi_write_png(job->filename, job->width, job->height, 4, job->pixels, stride);
+    } else if (strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0) {
+        written = stbi_write_jpg(job->filename, job->width, job->height, 4, job->pixels, 90);
+    } else if (strcasecmp(extension, "bmp") == 0) {
+        written = stbi_write_bmp(job->filename, job->width, job->height, 4, job->pixels);
+    } else if (strcasecmp(extension, "tga") == 0) {
+        written = stbi_write_tga(job->filename, job->width, job->height, 4, job->pixels);
+    } else {
+        FILE* file = fopen(job->filename, "wb");
+        written = file && fwrite(job->pixels, stride, job->height, file) == (size_t)job->height;
+        if (file) fclose(file);
+    }
+    if (!written) printf("Failed to save capture %s\n", job->filename);
+}
+
+static void* CaptureWorker(void* arg) {
+    pthread_mutex_lock(&capture.lock);
+    while (true) {
+        CaptureJob* job = capture.head;
+        if (!job) {
+            if (capture.stop) break;
+            pthread_cond_wait(&capture.wake, &capture.lock);
+            continue;
+        }
+        capture.head = job->next;
+        if (!capture.head) capture.tail = NULL;
+        pthread_mutex_unlock(&capture.lock);
+        CaptureWrite(job);
+        free(job->pixels);
+        free(job->filename);
+        free(job);
+        pthread_mutex_lock(&capture.lock);
+        capture.pending--;
+    }
+    pthread_mutex_unlock(&capture.lock);
+    return NULL;
+}
+
+// Copies a finished readback out of its buffer and queues it for the workers
+static void CaptureCollect(CaptureSlot* slot) {
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+    CaptureJob* job = calloc(1, sizeof(CaptureJob));
+    job->width = slot->width;
+    job->height = slot->height;
+    job->filename = slot->filename;
+    job->pixels = malloc(slot->size);
+    slot->filename = NULL;
+    StateBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot->size, GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(job->pixels, mapped, slot->size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        memset(job->pixels, 0, slot->size);
+    }
+    StateBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    pthread_mutex_lock(&capture.lock);
+    while (capture.workercount < CAPTURE_WORKERS) {
+        if (pthread_create(&capture.workers[capture.workercount], NULL, CaptureWorker, NULL) != 0) break;
+        capture.workercount++;
+    }
+    if (capture.tail) capture.tail->next = job; else capture.head = job;
+    capture.tail = job;
+    capture.pending++;
+    pthread_cond_signal(&capture.wake);
+    pthread_mutex_unlock(&capture.lock);
+    if (capture.workercount == 0) {
+        // No threads, write it here rather than lose it
+            pthread_mutex_lock(&capture.lock);
+            capture.head = capture.tail = NULL;
+            capture.pending--;
+            pthread_mutex_unlock(&capture.lock);
+            CaptureWrite(job);
+            free(job->pixels);
+            free(job->filename);
+            free(job);
+    }
+}
+
+// Starts an asynchronous readback of the back buffer, the file is written a few frames later off the render thread
+void CaptureScreenshot(const char* filename, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    BatchFlush();
+    // Free slot, or the oldest one once it is done
+        CaptureSlot* slot = NULL;
+        for (int i = 0; i < CAPTURE_SLOTS && !slot; ++i) {
+            if (!capture.slots[i].fence) slot = &capture.slots[i];
+        }
+        if (!slot) {
+            slot = &capture.slots[0];
+            for (int i = 1; i < CAPTURE_SLOTS; ++i) {
+                if (capture.slots[i].serial < slot->serial) slot = &capture.slots[i];
+            }
+            glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            CaptureCollect(slot);
+        }
+    GLsizeiptr size = (GLsizeiptr)width * height * 4;
+    if (!slot->pbo) glGenBuffers(1, &slot->pbo);
+    StateBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    if (slot->size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot->size = size;
+    }
+    int adjustedY = window.screen_height - y - height;
+    glReadPixels(x, adjustedY, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    StateBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->width = width;
+    slot->height = height;
+    slot->filename = strdup(filename);
+    slot->serial = capture.captured++;
+}
+
 void SaveScreenshot(const char *filename, int x, int y, int width, int height) {
     printf("Saving screenshot to -> %s\n", filename);
-    unsigned char *pixels = malloc(width * height * 4); // RGBA
-    if (!pixels) return;
-    int adjustedY = window.screen_height - y - height;
-    glReadPixels(x, adjustedY, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-    unsigned char *flippedPixels = malloc(width * height * 4);
-    if (!flippedPixels) {
-        free(pixels);
-        return;
-    }
-    for (int row = 0; row < height; row++) {
-        memcpy(flippedPixels + row * width * 4, pixels + (height - 1 - row) * width * 4, width * 4);
-    }
-    stbi_write_jpg(filename, width, height, 4, flippedPixels, width * 4);
-    free(pixels);
-    free(flippedPixels);
+    CaptureScreenshot(filename, x, y, width, height);
+}
+
+// Records every frame into pattern, a printf format taking the frame number such as "frames/%05d.png"
+void CaptureStart(const char* pattern) {
+    free(capture.pattern);
+    capture.pattern = strdup(pattern);
+    capture.frame = 0;
+}
+
+void CaptureStop(void) {
+    free(capture.pattern);
+    capture.pattern = NULL;
+}
+
+// Runs before the swap: queues the recording frame and hands finished readbacks to the workers without waiting
+void CaptureFrame(void) {
+    if (capture.pattern) {
+        char filename[1024];
+        snprintf(filename, sizeof(filename), capture.pattern, capture.frame++);
+        CaptureScreenshot(filename, 0, 0, window.screen_width, window.screen_height);
+    }
+    for (int i = 0; i < CAPTURE_SLOTS; ++i) {
+        CaptureSlot* slot = &capture.slots[i];
+        if (slot->fence && glClientWaitSync(slot->fence, 0, 0) != GL_TIMEOUT_EXPIRED) CaptureCollect(slot);
+    }
+}
+
+// Waits for every readback and every file still being written
+void CaptureTerminate(void) {
+    CaptureStop();
+    for (int i = 0; i < CAPTURE_SLOTS; ++i) {
+        CaptureSlot* slot = &capture.slots[i];
+        if (slot->fence) {
+            glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            CaptureCollect(slot);
+        }
+        if (slot->pbo) StateDeleteBuffer(slot->pbo);
+        *slot = (CaptureSlot){0};
+    }
+    pthread_mutex_lock(&capture.lock);
+    capture.stop = true;
+    pthread_cond_broadcast(&capture.wake);
+    pthread_mutex_unlock(&capture.lock);
+    for (int i = 0; i < capture.workercount; ++i) {
+        pthread_join(capture.workers[i], NULL);
+    }
+    capture.workercount = 0;
+    capture.stop = false;
 }
@@ -0,0 +1,133 @@
+// Instanced Drawing
+
+#define INSTANCE_FLOAT_PER_INSTANCE 24 // color4, model16, uvrect4
+
+typedef struct {
+    Transform transform;
+    Color color;
+    float u0, v0, u1, v1; // All zero samples the whole texture
+} Instance;
+
+static GLfloat* instancedata = NULL;
+static size_t instancecapacity = 0;
+static Mesh instancequad = {0};
+static Mesh instancecube = {0};
+
+// Scale first, then rotate around pivot and move to the instance position
+static void InstanceMatrix(Transform transform, Vec3 scale, Vec3 pivot, GLfloat* out) {
+    MatrixTRS(transform.position, transform.rotation, scale, pivot, out);
+}
+
+static void InstancePack(const Instance* instances, size_t count, Vec3 scale, Vec3 pivot) {
+    if (count > instancecapacity) {
+        instancecapacity = count;
+        instancedata = realloc(instancedata, instancecapacity * INSTANCE_FLOAT_PER_INSTANCE * sizeof(GLfloat));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        GLfloat* out = instancedata + i * INSTANCE_FLOAT_PER_INSTANCE;
+        Instance instance = instances[i];
+        if (instance.color.a == 0) instance.color.a = 255;
+        if (instance.u1 == 0.0f && instance.v1 == 0.0f) {
+            instance.u1 = 1.0f;
+            instance.v1 = 1.0f;
+        }
+        out[0] = instance.color.r / 255.0f;
+        out[1] = instance.color.g / 255.0f;
+        out[2] = instance.color.b / 255.0f;
+        out[3] = instance.color.a / 255.0f;
+        InstanceMatrix(instance.transform, scale, pivot, out + 4);
+        out[20] = instance.u0;
+        out[21] = instance.v0;
+        out[22] = instance.u1;
+        out[23] = instance.v1;
+    }
+}
+
+static void InstanceRender(Mesh mesh, size_t count, GLuint texture, Shader shader, Camera cam) {
+    if (!mesh.VAO || count == 0) return;
+    BatchFlush();
+    if (shader.hotreloading) shader = ShaderHotReload(shader);
+    // Model Matrix, the instances carry their own transforms
+        ShaderObject obj = {cam, shader, NULL, NULL, 0, 0, cam.transform, mesh.is3d};
+        GLfloat Model[16];
+        if (mesh.is3d) {
+            obj.transform = (Transform){0};
+            MatrixIdentity(Model);
+        } else {
+            CalculateModel(obj, Model);
+        }
+        UseFrameUniforms(obj);
+    // Depth and Debug
+        SetRenderState(obj);
+    // Blend and Texture
+        if (!texture) texture = GetCachedTexture((Color){255, 255, 255, 255}, true, false, NULL, 0, 0);
+        StateEnable(GL_BLEND, true);
+        StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        StateBindTexture(texture);
+    // Append the instance attributes to the ring buffer
+        StateBindVertexArray(mesh.VAO);
+        GLsizei stride = INSTANCE_FLOAT_PER_INSTANCE * sizeof(GLfloat);
+        GLintptr offset = StreamUpload(&streamvertex, instancedata, count * stride, sizeof(GLfloat));
+    // Instance color attribute (matches aColor in your shader)
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        glVertexAttribDivisor(2, 1);
+    // Instance model matrix attribute, one column per location (matches aModel in your shader)
+        for (int i = 0; i < 4; ++i) {
+            glEnableVertexAttribArray(3 + i);
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + (4 + i * 4) * sizeof(GLfloat)));
+            glVertexAttribDivisor(3 + i, 1);
+        }
+    // Instance uv rect attribute (matches aUVRect in your shader)
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 20 * sizeof(GLfloat)));
+        glVertexAttribDivisor(7, 1);
+    // Use the shader program
+        StateUseProgram(shader.Program);
+    // Set uniforms
+        glUniformMatrix4fv(shader.locations.model, 1, GL_FALSE, Model);
+        SetFrameUniforms(shader);
+    // Draw every instance at once
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.indexcount, GL_UNSIGNED_INT, 0, count);
+    // Leave the mesh usable by DrawMesh
+        for (int i = 2; i < 8; ++i) {
+            glDisableVertexAttribArray(i);
+        }
+}
+
+void DrawMeshInstanced(Mesh mesh, const Instance* instances, size_t count, GLuint texture, Shader shader, Camera cam) {
+    InstancePack(instances, count, (Vec3){1.0f, 1.0f, 1.0f}, (Vec3){0.0f, 0.0f, 0.0f});
+    InstanceRender(mesh, count, texture, shader, cam);
+}
+
+void DrawCubeInstanced(const Instance* instances, size_t count, float size, GLuint texture) {
+    if (!instancecube.VAO) instancecube = LoadMeshCube(1.0f);
+    InstancePack(instances, count, (Vec3){size, size, size}, (Vec3){0.0f, 0.0f, 0.0f});
+    InstanceRender(instancecube, count, texture, shaderinstanced, camera);
+}
+
+// Positions are the top left corner in pixels like DrawRect, rotation turns around the rect center
+void DrawRectInstanced(const Instance* instances, size_t count, float width, float height, GLuint texture) {
+    if (!instancequad.VAO) {
+        GLfloat vertices[] = {
+            0.0f, 1.0f, 0.0f, 0.0f, 0.0f, // Bottom Left
+            1.0f, 1.0f, 0.0f, 1.0f, 0.0f, // Bottom Right
+            0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Top Left
+            1.0f, 0.0f, 0.0f, 1.0f, 1.0f  // Top Right
+        };
+        GLuint indices[] = {0, 1, 2, 1, 3, 2};
+        instancequad = LoadMesh(vertices, 4, indices, 6, false);
+    }
+    InstancePack(instances, count, (Vec3){width, height, 1.0f}, (Vec3){width / 2.0f, height / 2.0f, 0.0f});
+    InstanceRender(instancequad, count, texture, shaderinstanced, camera);
+}
+
+void InstanceTerminate(void) {
+    if (instancequad.VAO) UnloadMesh(instancequad);
+    if (instancecube.VAO) UnloadMesh(instancecube);
+    instancequad = (Mesh){0};
+    instancecube = (Mesh){0};
+    free(instancedata);
+    instancedata = NULL;
+    instancecapacity = 0;
+}
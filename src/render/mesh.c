@@ -0,0 +1,114 @@
+// Mesh
+
+typedef struct {
+    GLuint VAO;
+    GLuint VBO;
+    GLuint EBO;
+    GLsizei indexcount;
+    bool is3d;
+} Mesh;
+
+// Uploads FLOAT_PER_VERTEX vertices (position, uv) once, the buffers stay on the GPU until UnloadMesh
+Mesh LoadMesh(const GLfloat* vertices, size_t vertexcount, const GLuint* indices, size_t indexcount, bool is3d) {
+    Mesh mesh = {0};
+    mesh.indexcount = indexcount;
+    mesh.is3d = is3d;
+    // Generate VAO, VBO, and EBO
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        glGenBuffers(1, &mesh.EBO);
+        StateBindVertexArray(mesh.VAO);
+    // Upload vertex and index data
+        StateBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexcount * FLOAT_PER_VERTEX * sizeof(GLfloat), vertices, GL_STATIC_DRAW);
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexcount * sizeof(GLuint), indices, GL_STATIC_DRAW);
+    // Vertex positions attribute (matches aPos in your shader)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)0);
+    // Texture coordinates attribute (matches aTexCoords in your shader)
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    return mesh;
+}
+
+// Same faces and uvs as Cube, centered on the origin so the Transform places it
+Mesh LoadMeshCube(float size) {
+    GLfloat hs = size / 2.0f;
+    GLfloat vertices[] = {
+        // Front face
+        -hs, -hs,  hs, 0.0f, 0.0f,
+         hs, -hs,  hs, 1.0f, 0.0f,
+         hs,  hs,  hs, 1.0f, 1.0f,
+        -hs,  hs,  hs, 0.0f, 1.0f,
+        // Back face
+        -hs, -hs, -hs, 0.0f, 0.0f,
+         hs, -hs, -hs, 1.0f, 0.0f,
+         hs,  hs, -hs, 1.0f, 1.0f,
+        -hs,  hs, -hs, 0.0f, 1.0f,
+        // Top face
+        -hs,  hs, -hs, 0.0f, 0.0f,
+         hs,  hs, -hs, 1.0f, 0.0f,
+         hs,  hs,  hs, 1.0f, 1.0f,
+        -hs,  hs,  hs, 0.0f, 1.0f,
+        // Bottom face
+        -hs, -hs, -hs, 0.0f, 1.0f,
+         hs, -hs, -hs, 1.0f, 1.0f,
+         hs, -hs,  hs, 1.0f, 0.0f,
+        -hs, -hs,  hs, 0.0f, 0.0f,
+        // Right face
+         hs, -hs, -hs, 0.0f, 0.0f,
+         hs,  hs, -hs, 0.0f, 1.0f,
+         hs,  hs,  hs, 1.0f, 1.0f,
+         hs, -hs,  hs, 1.0f, 0.0f,
+        // Left face
+        -hs, -hs, -hs, 0.0f, 0.0f,
+        -hs,  hs, -hs, 1.0f, 0.0f,
+        -hs,  hs,  hs, 1.0f, 1.0f,
+        -hs, -hs,  hs, 0.0f, 1.0f
+    };
+    GLuint indices[] = {
+        0, 1, 2, 2, 3, 0,       // Front face
+        4, 7, 6, 6, 5, 4,       // Back face
+        8, 11, 10, 10, 9, 8,    // Top face
+        12, 13, 14, 14, 15, 12, // Bottom face
+        16, 17, 18, 18, 19, 16, // Right face
+        20, 23, 22, 22, 21, 20  // Left face
+    };
+    return LoadMesh(vertices, 24, indices, 36, true);
+}
+
+// Only the model matrix changes per draw, the geometry is already on the GPU
+void DrawMesh(Mesh mesh, Transform transform, Shader shader, Camera cam) {
+    if (!mesh.VAO || mesh.indexcount == 0) return;
+    BatchFlush();
+    if (shader.hotreloading) shader = ShaderHotReload(shader);
+    ShaderObject obj = {cam, shader, NULL, NULL, 0, 0, transform, mesh.is3d};
+    // Model Matrix
+        GLfloat Model[16];
+        if (mesh.is3d) {
+            MatrixTRS(transform.position, transform.rotation, (Vec3){1.0f, 1.0f, 1.0f}, (Vec3){0.0f, 0.0f, 0.0f}, Model);
+        } else {
+            CalculateModel(obj, Model);
+        }
+        UseFrameUniforms(obj);
+    // Depth and Debug
+        SetRenderState(obj);
+    // Bind VAO
+        StateBindVertexArray(mesh.VAO);
+    // Default vertex color (matches aColor in your shader)
+        glVertexAttrib4f(2, 1.0f, 1.0f, 1.0f, 1.0f);
+    // Use the shader program
+        StateUseProgram(shader.Program);
+    // Set uniforms
+        glUniformMatrix4fv(shader.locations.model, 1, GL_FALSE, Model);
+        SetFrameUniforms(shader);
+    // Draw using indices
+        glDrawElements(GL_TRIANGLES, mesh.indexcount, GL_UNSIGNED_INT, 0);
+}
+
+void UnloadMesh(Mesh mesh) {
+    StateDeleteVertexArray(mesh.VAO);
+    StateDeleteBuffer(mesh.VBO);
+    StateDeleteBuffer(mesh.EBO);
+}
@@ -34,45 +34,30 @@ typedef struct {
     bool is3d;
 } ShaderObject;
 
-void CalculateProjections(ShaderObject obj, GLfloat *Model, GLfloat *Projection, GLfloat *View) {
-    Vec3 lpos = obj.transform.localposition;
+void CalculateModel(ShaderObject obj, GLfloat *Model) {
     Vec3 pos = obj.transform.position;
     Vec3 rot = obj.transform.rotation;
-    Vec3 clpos = obj.cam.transform.localposition;
+    if(obj.cam.fov > 0.0f || obj.is3d){ // Perspective projection or model vertices also in z axys
+        MatrixTRS((Vec3){0.0f, 0.0f, 0.0f}, rot, (Vec3){1.0f, 1.0f, 1.0f}, pos, Model); // Rotate around the position
+    } else {
+        MatrixTRS((Vec3){pos.x, pos.y, 0.0f}, rot, (Vec3){1.0f, 1.0f, 1.0f}, (Vec3){0.0f, 0.0f, 0.0f}, Model);
+    }
+}
+
+void CalculateCamera(ShaderObject obj, GLfloat *Projection, GLfloat *View) {
+    Vec3 lpos = obj.transform.localposition;
+    Vec3 pos = obj.transform.position;
     Vec3 cpos = obj.cam.transform.position;
-    Vec3 crot = obj.cam.transform.rotation;
-    float centerX = window.screen_width / 2.0f;
-    float centerY = window.screen_height / 2.0f;
     float distance = 1.0f;
-    GLfloat translateToCenter[16], rotate[16], translateBack[16], translateFinal[16];
     if(obj.cam.far == 0.0f)
         obj.cam.far = 1000.0f;
     if(obj.cam.fov > 0.0f){ // Perspective projection
         MatrixPerspective(obj.cam.fov, window.screen_width / window.screen_height, obj.cam.near, obj.cam.far, obj.is3d, Projection);
-        MatrixTranslate(-obj.transform.position.x, -obj.transform.position.y, -obj.transform.position.z, translateToCenter);
-        MatrixRotate(rot.x, rot.y, rot.z, rotate);
-        MatrixMultiply(translateToCenter, rotate, Model);
-        MatrixTranslate(obj.transform.position.x, obj.transform.position.y, obj.transform.position.z, translateBack);
-        MatrixMultiply(Model, translateBack, Model);
         distance = 3.0f;
-    } else { // Orthographic projection
-        if(obj.is3d) { // if the model vertices are also in z axys
-            MatrixOrthographicZoom(0.0f, window.screen_width, window.screen_height, 0.0f, obj.cam.near, obj.cam.far, pos.z + cpos.z, obj.is3d, Projection);
-            MatrixTranslate(-obj.transform.position.x, -obj.transform.position.y, -obj.transform.position.z, translateToCenter);
-            MatrixRotate(rot.x, rot.y, rot.z, rotate);
-            MatrixMultiply(translateToCenter, rotate, Model);
-            MatrixTranslate(obj.transform.position.x, obj.transform.position.y, obj.transform.position.z, translateBack);
-            MatrixMultiply(Model, translateBack, Model);
-        } else {
-            MatrixOrthographicZoom(0.0f, window.screen_width, window.screen_height, 0.0f, obj.cam.near, obj.cam.far, pos.z, obj.is3d, Projection);
-            MatrixTranslate(-centerX, -centerY, 0.0f, translateToCenter);
-            MatrixTranslate(centerX, centerY, 0.0f, translateBack);
-            MatrixMultiply(translateToCenter, translateBack, translateBack);
-            MatrixRotate(rot.x, rot.y, rot.z, rotate);
-            MatrixMultiply(translateBack, rotate, Model);
-            MatrixTranslate(pos.x, pos.y, 0.0f, translateFinal);
-            MatrixMultiply(Model, translateFinal, Model);
-        }
+    } else if(obj.is3d) { // Orthographic projection
+        MatrixOrthographicZoom(0.0f, window.screen_width, window.screen_height, 0.0f, obj.cam.near, obj.cam.far, pos.z + cpos.z, obj.is3d, Projection);
+    } else {
+        MatrixOrthographicZoom(0.0f, window.screen_width, window.screen_height, 0.0f, obj.cam.near, obj.cam.far, pos.z, obj.is3d, Projection);
     }
     MatrixLookAt(
         lpos.x, lpos.y, lpos.z + distance, // Eye position
@@ -82,64 +67,139 @@ void CalculateProjections(ShaderObject obj, GLfloat *Model, GLfloat *Projection,
     );
 }
 
-void RenderShader(ShaderObject obj) {
-    if (obj.shader.hotreloading) obj.shader = ShaderHotReload(obj.shader);
-    // Projection Matrix
-        GLfloat Projection[16], Model[16], View[16];
-        CalculateProjections(obj,Model,Projection,View);
+void CalculateProjections(ShaderObject obj, GLfloat *Model, GLfloat *Projection, GLfloat *View) {
+    CalculateModel(obj, Model);
+    CalculateCamera(obj, Projection, View);
+}
+
+// Frame Uniforms
+
+typedef struct {
+    GLfloat projection[16];
+    GLfloat view[16];
+    GLfloat iResolution[2];
+    GLfloat iMouse[2];
+    GLfloat iTime;
+    GLfloat padding[3];
+} FrameUniforms; // std140 layout of the Frame block
+
+typedef struct {
+    Camera cam;
+    Vec3 eye;
+    float zoom;
+    int width;
+    int height;
+    bool is3d;
+} FrameCamera;
+
+FrameUniforms frameuniforms;
+static FrameCamera framecamera;
+static bool framedirty = true;
+static int frametarget[2]; // Size of the bound render target, iResolution follows it, zero for the window
+
+static void FrameResolution(void) {
+    frameuniforms.iResolution[0] = frametarget[0] ? frametarget[0] : window.screen_width;
+    frameuniforms.iResolution[1] = frametarget[1] ? frametarget[1] : window.screen_height;
+}
+
+void SetFrameResolution(int width, int height) {
+    frametarget[0] = width;
+    frametarget[1] = height;
+    FrameResolution();
+    framedirty = true;
+}
+
+void UpdateFrameUniforms(void) {
+    FrameResolution();
+    frameuniforms.iMouse[0] = mouse.x;
+    frameuniforms.iMouse[1] = mouse.y;
+    frameuniforms.iTime = glfwGetTime();
+    framedirty = true;
+}
+
+void UseFrameUniforms(ShaderObject obj) {
+    FrameCamera current;
+    memset(&current, 0, sizeof(FrameCamera));
+    current.cam = obj.cam;
+    current.eye = obj.transform.localposition;
+    if (obj.cam.fov <= 0.0f) current.zoom = obj.is3d ? obj.transform.position.z + obj.cam.transform.position.z : obj.transform.position.z;
+    current.width = window.screen_width;
+    current.height = window.screen_height;
+    current.is3d = obj.is3d;
+    if (memcmp(&current, &framecamera, sizeof(FrameCamera)) != 0) {
+        CalculateCamera(obj, frameuniforms.projection, frameuniforms.view);
+        FrameResolution();
+        framecamera = current;
+        framedirty = true;
+    }
+    if (framedirty) {
+        StateBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frameuniforms, GL_DYNAMIC_DRAW);
+        framedirty = false;
+    }
+}
+
+void SetFrameUniforms(Shader shader) {
+    // Shaders that declare the inputs as plain uniforms instead of the Frame block
+    if (shader.locations.projection != -1) glUniformMatrix4fv(shader.locations.projection, 1, GL_FALSE, frameuniforms.projection);
+    if (shader.locations.view != -1) glUniformMatrix4fv(shader.locations.view, 1, GL_FALSE, frameuniforms.view);
+    if (shader.locations.iTime != -1) glUniform1f(shader.locations.iTime, frameuniforms.iTime);
+    if (shader.locations.iResolution != -1) glUniform2fv(shader.locations.iResolution, 1, frameuniforms.iResolution);
+    if (shader.locations.iMouse != -1) glUniform2fv(shader.locations.iMouse, 1, frameuniforms.iMouse);
+}
+
+void SetRenderState(ShaderObject obj) {
     // Depth
         if(obj.is3d) {
+            StateEnable(GL_DEPTH_TEST, true);
+            StateEnable(GL_CULL_FACE, true);
+            StateFrontFace(GL_CCW);
             if(obj.cam.fov > 0.0f){
-                glEnable(GL_DEPTH_TEST);
-                glDepthFunc(GL_LEQUAL);
-                glEnable(GL_CULL_FACE);
-                glCullFace(GL_BACK);
+                StateDepthFunc(GL_LEQUAL);
+                StateCullFace(GL_BACK);
             } else {
-                glEnable(GL_DEPTH_TEST);
-                glDepthFunc(GL_LESS);
-                glEnable(GL_CULL_FACE);
-                glCullFace(GL_FRONT);
+                StateDepthFunc(GL_LESS);
+                StateCullFace(GL_FRONT);
             }
+        } else {
+            StateEnable(GL_DEPTH_TEST, false);
+            StateEnable(GL_CULL_FACE, false);
         }
     // Debug
         if (window.debug.wireframe) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            StatePolygonMode(GL_LINE);
         } else if (window.debug.point) {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+            StatePolygonMode(GL_POINT);
             if(window.debug.pointsize > 0) glPointSize(window.debug.pointsize);
         } else {
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            StatePolygonMode(GL_FILL);
         }
+}
+
+void RenderShader(ShaderObject obj) {
+    BatchFlush();
+    if (obj.shader.hotreloading) obj.shader = ShaderHotReload(obj.shader);
+    // Model Matrix
+        GLfloat Model[16];
+        CalculateModel(obj, Model);
+        UseFrameUniforms(obj);
+    // Depth and Debug
+        SetRenderState(obj);
     // Bind VAO
-        glBindVertexArray(VAO);
-    // Bind VBO and update with new vertex data
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, obj.size_vertices, obj.vertices);
-    // Bind EBO and update with new index data
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, obj.size_indices, obj.indices);
+        StateBindVertexArray(VAO);
+    // Default vertex color (matches aColor in your shader)
+        glVertexAttrib4f(2, 1.0f, 1.0f, 1.0f, 1.0f);
+    // Append vertex and index data to the ring buffers
+        GLintptr vertexoffset = StreamUpload(&streamvertex, obj.vertices, obj.size_vertices, FLOAT_PER_VERTEX * sizeof(GLfloat));
+        GLintptr indexoffset = StreamUpload(&streamindex, obj.indices, obj.size_indices, sizeof(GLuint));
+        if (vaogeneration != streamvertex.generation) ShaderAttributes();
     // Use the shader program
-        glUseProgram(obj.shader.Program);
+        StateUseProgram(obj.shader.Program);
     // Set uniforms
-        GLumatrix4fv(obj.shader, "projection", Projection);
-        GLumatrix4fv(obj.shader, "model", Model);
-        GLumatrix4fv(obj.shader, "view", View);
-        GLuint1f(obj.shader, "iTime", glfwGetTime());
-        GLuint2f(obj.shader, "iResolution", window.screen_width, window.screen_height);
-        GLuint2f(obj.shader, "iMouse", mouse.x, mouse.y);
+        glUniformMatrix4fv(obj.shader.locations.model, 1, GL_FALSE, Model);
+        SetFrameUniforms(obj.shader);
     // Draw using indices
-        glDrawElements(GL_TRIANGLES, obj.size_indices / sizeof(GLuint), GL_UNSIGNED_INT, 0);
-    // Unbind shader program
-        glUseProgram(0);
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    // Disable Effects
-        if(obj.is3d) {
-            glDisable(GL_CULL_FACE);
-            glDisable(GL_DEPTH_TEST);
-        }
+        glDrawElementsBaseVertex(GL_TRIANGLES, obj.size_indices / sizeof(GLuint), GL_UNSIGNED_INT, (void*)indexoffset, vertexoffset / (FLOAT_PER_VERTEX * sizeof(GLfloat)));
 }
 
 typedef struct {
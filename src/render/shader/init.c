@@ -1,62 +1,117 @@
 
+typedef struct {
+    GLint projection;
+    GLint model;
+    GLint view;
+    GLint iTime;
+    GLint iResolution;
+    GLint iMouse;
+    GLint Color;
+    GLint Size;
+} ShaderLocations;
+
+typedef struct {
+    char* name;
+    unsigned int hash;
+    GLint location;
+} ShaderUniform;
+
+typedef struct {
+    ShaderUniform* slots;
+    size_t capacity;
+    size_t count;
+} ShaderUniforms;
+
 typedef struct {
     GLuint Program;
     const char* vertex;
     const char* fragment;
-    time_t lastvertmodtime;
-    time_t lastfragmodtime;
+    unsigned int features;   // Feature bits the sources were preprocessed with, see shaderfeatures
     bool hotreloading;
+    ShaderLocations locations;
+    ShaderUniforms* uniforms;
 } Shader;
 
 GLuint VAO;
-GLuint VBO;
-GLuint EBO;
+GLuint UBO;
 
 #define FLOAT_PER_VERTEX 5
+#define FRAME_UNIFORMS_BINDING 0
+
+#define SHADER_INCLUDE_DEPTH 16
+#define SHADER_FEATURES_MAX 32
+#define SHADER_SDF (1u << 0)     // font.frag samples a signed distance atlas
+#define SHADER_CURSOR (1u << 1)  // font.frag inverts the coverage under the selection
+
+typedef struct {
+    char** paths;
+    int count;
+} ShaderIncludes;
 
 Shader shaderdefault;
 Shader shaderfont;
+Shader shaderfontsdf;
+Shader shaderinstanced;
+Shader shadershape;
 
-#include "utils.c"
-#include "math.c"
-#include "camera.c"
+void BatchFlush(void);
 
-void InitializeShader() {
-    // Generate Shader default
-        shaderdefault = LoadShader("./res/shaders/default.vert","./res/shaders/default.frag");
-        shaderfont = LoadShader("./res/shaders/default.vert","./res/shaders/font.frag");
-    // Generate VAO, VBO, and EBO
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-    // Bind VAO
-        glBindVertexArray(VAO);
-    // Bind VBO
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    // Get Max Capacity EBO Buffer
-        GLint maxElementBufferSize;
-        glGetIntegerv(GL_MAX_ELEMENT_INDEX, &maxElementBufferSize);
-    // Allocate memory for VBO
-        glBufferData(GL_ARRAY_BUFFER, GL_MAX_VERTEX_ATTRIBS * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
-    // Bind EBO and allocate memory for it
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, GL_MAX_ELEMENT_INDEX * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+static int vaogeneration = 0;
+
+// Points the shared VAO at the current vertex ring buffer
+void ShaderAttributes(void) {
+    StateBindVertexArray(VAO);
+    StateBindBuffer(GL_ARRAY_BUFFER, streamvertex.buffer);
     // Vertex positions attribute (matches aPos in your shader)
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)0);
     // Texture coordinates attribute (matches aTexCoords in your shader)
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, FLOAT_PER_VERTEX * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-    // Unbind VBO
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-    // Unbind VAO
-        glBindVertexArray(0);
+    vaogeneration = streamvertex.generation;
+}
+
+#include "utils.c"
+#include "math.c"
+#include "camera.c"
+
+void InitializeShader() {
+    // Generate Shader default, every compile is issued before any result is read back
+        ShaderCompilerInit();
+        LoadShaderAsync(&shaderdefault, "./res/shaders/default.vert","./res/shaders/default.frag");
+        LoadShaderAsync(&shaderfont, "./res/shaders/default.vert","./res/shaders/font.frag");
+        LoadShaderAsync(&shaderinstanced, "./res/shaders/instanced.vert","./res/shaders/default.frag");
+        LoadShaderAsync(&shadershape, "./res/shaders/shape.vert","./res/shaders/shape.frag");
+        shaderfontsdf = GetShaderVariant("./res/shaders/default.vert","./res/shaders/font.frag", SHADER_SDF);
+    // Generate VAO and the streaming ring buffers, they grow to what the frames really upload
+        glGenVertexArrays(1, &VAO);
+        StateBindVertexArray(VAO);
+        StreamInit(&streamvertex, GL_ARRAY_BUFFER, 256 * 1024);
+        StreamInit(&streamindex, GL_ELEMENT_ARRAY_BUFFER, 64 * 1024);
+        ShaderAttributes();
+    // Generate UBO for the per-frame inputs (matches the Frame block in your shader)
+        glGenBuffers(1, &UBO);
+        StateBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, UBO);
+        UpdateFrameUniforms();
+    // The defaults are drawn with from the first frame
+        ShaderWait(&shaderdefault);
+        ShaderWait(&shaderfont);
+        ShaderWait(&shaderinstanced);
+        ShaderWait(&shadershape);
 }
 
 void TerminateShader(void){
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderdefault.Program);
-    glDeleteProgram(shaderfont.Program);   
+    ShaderCompilerTerminate();
+    StateDeleteVertexArray(VAO);
+    StreamTerminate(&streamvertex);
+    StreamTerminate(&streamindex);
+    StateDeleteBuffer(UBO);
+    DeleteShader(shaderdefault);
+    DeleteShader(shaderfont);
+    DeleteShader(shaderinstanced);
+    DeleteShader(shadershape);
+    ShaderVariantsClear();
+    ShaderRegistryTerminate();
 }
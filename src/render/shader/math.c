@@ -1,18 +1,63 @@
 
+// Matrix Math
+
+// Matrices are column major like GL expects them. The SSE kernels are used on every x86-64 build,
+// the AVX ones when the library is built with -mavx or -march=native, anything else runs the scalar code
+#if defined(__SSE__)
+    #include <immintrin.h>
+#endif
+
 void MatrixIdentity(GLfloat* out) {
     memset(out, 0, 16 * sizeof(GLfloat));
     out[0] = out[5] = out[10] = out[15] = 1.0f;
 }
 
+// Both inputs are read in full before result is written, so result may alias either of them
 void MatrixMultiply(const GLfloat* a, const GLfloat* b, GLfloat* result) {
+#if defined(__AVX__)
+    // Two rows of a per register, each lane broadcasts its own row elements
+        __m256 b0 = _mm256_broadcast_ps((const __m128*)(b + 0));
+        __m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+        __m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+        __m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+        __m256 a01 = _mm256_loadu_ps(a);
+        __m256 a23 = _mm256_loadu_ps(a + 8);
+        __m256 r01 = _mm256_mul_ps(_mm256_permute_ps(a01, 0x00), b0);
+        __m256 r23 = _mm256_mul_ps(_mm256_permute_ps(a23, 0x00), b0);
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0x55), b1));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_permute_ps(a23, 0x55), b1));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0xAA), b2));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_permute_ps(a23, 0xAA), b2));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_permute_ps(a01, 0xFF), b3));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_permute_ps(a23, 0xFF), b3));
+        _mm256_storeu_ps(result, r01);
+        _mm256_storeu_ps(result + 8, r23);
+#elif defined(__SSE__)
+    __m128 b0 = _mm_loadu_ps(b + 0);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+    __m128 r[4];
+    for (int i = 0; i < 4; ++i) {
+        __m128 row = _mm_loadu_ps(a + i * 4);
+        r[i] = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+        r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+        r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+        r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+    }
+    for (int i = 0; i < 4; ++i) _mm_storeu_ps(result + i * 4, r[i]);
+#else
+    GLfloat r[16];
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
-            result[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] +
-                                a[i * 4 + 1] * b[1 * 4 + j] +
-                                a[i * 4 + 2] * b[2 * 4 + j] +
-                                a[i * 4 + 3] * b[3 * 4 + j];
+            r[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] +
+                           a[i * 4 + 1] * b[1 * 4 + j] +
+                           a[i * 4 + 2] * b[2 * 4 + j] +
+                           a[i * 4 + 3] * b[3 * 4 + j];
         }
     }
+    memcpy(result, r, sizeof(r));
+#endif
 }
 
 void MatrixLookAt(GLfloat eyeX, GLfloat eyeY, GLfloat eyeZ, GLfloat centerX, GLfloat centerY, GLfloat centerZ, GLfloat upX, GLfloat upY, GLfloat upZ, GLfloat* matrix) {
@@ -32,33 +77,33 @@ void MatrixLookAt(GLfloat eyeX, GLfloat eyeY, GLfloat eyeZ, GLfloat centerX, GLf
     matrix[15] = 1.0f;
 }
 
+// Same result as multiplying the X, Y and Z rotations in that order, written out directly
 void MatrixRotate(GLfloat angleX, GLfloat angleY, GLfloat angleZ, GLfloat* matrix) {
     GLfloat cx = cosf(angleX), sx = sinf(angleX);
     GLfloat cy = cosf(angleY), sy = sinf(angleY);
     GLfloat cz = cosf(angleZ), sz = sinf(angleZ);
-    GLfloat Rx[16] = {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, cx, -sx, 0.0f,
-        0.0f, sx, cx, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    GLfloat Ry[16] = {
-        cy, 0.0f, sy, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        -sy, 0.0f, cy, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    GLfloat Rz[16] = {
-        cz, -sz, 0.0f, 0.0f,
-        sz, cz, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    GLfloat Rxy[16];
-    GLfloat R[16];
-    MatrixMultiply(Ry, Rx, Rxy);
-    MatrixMultiply(Rz, Rxy, R);
-    memcpy(matrix, R, sizeof(GLfloat) * 16);
+    matrix[0] = cz * cy;  matrix[1] = cz * sy * sx - sz * cx; matrix[2] = cz * sy * cx + sz * sx;  matrix[3] = 0.0f;
+    matrix[4] = sz * cy;  matrix[5] = sz * sy * sx + cz * cx; matrix[6] = sz * sy * cx - cz * sx;  matrix[7] = 0.0f;
+    matrix[8] = -sy;      matrix[9] = cy * sx;                matrix[10] = cy * cx;                matrix[11] = 0.0f;
+    matrix[12] = 0.0f;    matrix[13] = 0.0f;                  matrix[14] = 0.0f;                   matrix[15] = 1.0f;
+}
+
+// Scale, rotate around pivot, then move to position. Equals chaining the scale, pivot, rotation and
+// translation matrices through MatrixMultiply, without building or multiplying any of them
+void MatrixTRS(Vec3 position, Vec3 rotation, Vec3 scale, Vec3 pivot, GLfloat* matrix) {
+    GLfloat r[16];
+    MatrixRotate(rotation.x, rotation.y, rotation.z, r);
+    GLfloat s[3] = {scale.x, scale.y, scale.z};
+    for (int i = 0; i < 3; ++i) {
+        matrix[i * 4 + 0] = s[i] * r[i * 4 + 0];
+        matrix[i * 4 + 1] = s[i] * r[i * 4 + 1];
+        matrix[i * 4 + 2] = s[i] * r[i * 4 + 2];
+        matrix[i * 4 + 3] = 0.0f;
+    }
+    matrix[12] = position.x + pivot.x - (pivot.x * r[0] + pivot.y * r[4] + pivot.z * r[8]);
+    matrix[13] = position.y + pivot.y - (pivot.x * r[1] + pivot.y * r[5] + pivot.z * r[9]);
+    matrix[14] = position.z + pivot.z - (pivot.x * r[2] + pivot.y * r[6] + pivot.z * r[10]);
+    matrix[15] = 1.0f;
 }
 
 void MatrixTranslate(GLfloat tx, GLfloat ty, GLfloat tz, GLfloat *result) {
@@ -124,10 +169,21 @@ void MatrixOrthographicZoom(GLfloat left, GLfloat right, GLfloat bottom, GLfloat
 Vec3 MatrixMultiplyVector(const GLfloat matrix[16], Vec3 vector) {
     Vec3 result;
     GLfloat w;
+#if defined(__SSE__)
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(matrix), _mm_set1_ps(vector.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(matrix + 4), _mm_set1_ps(vector.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(matrix + 8), _mm_set1_ps(vector.z)));
+    r = _mm_add_ps(r, _mm_loadu_ps(matrix + 12));
+    GLfloat out[4];
+    _mm_storeu_ps(out, r);
+    result = (Vec3){out[0], out[1], out[2]};
+    w = out[3];
+#else
     result.x = matrix[0] * vector.x + matrix[4] * vector.y + matrix[8] * vector.z + matrix[12];
     result.y = matrix[1] * vector.x + matrix[5] * vector.y + matrix[9] * vector.z + matrix[13];
     result.z = matrix[2] * vector.x + matrix[6] * vector.y + matrix[10] * vector.z + matrix[14];
     w = matrix[3] * vector.x + matrix[7] * vector.y + matrix[11] * vector.z + matrix[15];
+#endif
     if (w != 1.0f && w != 0.0f) {
         result.x /= w;
         result.y /= w;
@@ -136,7 +192,57 @@ Vec3 MatrixMultiplyVector(const GLfloat matrix[16], Vec3 vector) {
     return result;
 }
 
+// Affine matrices skip the perspective divide and fold the offset into the translation column
 void TransformVertices(GLfloat *vertices, size_t vertexCount, const GLfloat *rotationMatrix, const Vec3 *positionOffset) {
+    const GLfloat* m = rotationMatrix;
+    if (m[3] == 0.0f && m[7] == 0.0f && m[11] == 0.0f && m[15] == 1.0f) {
+        size_t i = 0;
+    #if defined(__SSE__)
+        __m128 c0 = _mm_loadu_ps(m);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_add_ps(_mm_loadu_ps(m + 12), _mm_setr_ps(positionOffset->x, positionOffset->y, positionOffset->z, 0.0f));
+        #if defined(__AVX__)
+            // Two vertices per register, one in each lane
+                __m256 C0 = _mm256_set_m128(c0, c0);
+                __m256 C1 = _mm256_set_m128(c1, c1);
+                __m256 C2 = _mm256_set_m128(c2, c2);
+                __m256 C3 = _mm256_set_m128(c3, c3);
+                for (; i + 2 <= vertexCount; i += 2) {
+                    GLfloat* v0 = vertices + i * FLOAT_PER_VERTEX;
+                    GLfloat* v1 = v0 + FLOAT_PER_VERTEX;
+                    __m256 r = _mm256_add_ps(C3, _mm256_mul_ps(C0, _mm256_set_m128(_mm_set1_ps(v1[0]), _mm_set1_ps(v0[0]))));
+                    r = _mm256_add_ps(r, _mm256_mul_ps(C1, _mm256_set_m128(_mm_set1_ps(v1[1]), _mm_set1_ps(v0[1]))));
+                    r = _mm256_add_ps(r, _mm256_mul_ps(C2, _mm256_set_m128(_mm_set1_ps(v1[2]), _mm_set1_ps(v0[2]))));
+                    __m128 lo = _mm256_castps256_ps128(r);
+                    __m128 hi = _mm256_extractf128_ps(r, 1);
+                    _mm_storel_pi((__m64*)v0, lo);
+                    v0[2] = _mm_cvtss_f32(_mm_movehl_ps(lo, lo));
+                    _mm_storel_pi((__m64*)v1, hi);
+                    v1[2] = _mm_cvtss_f32(_mm_movehl_ps(hi, hi));
+                }
+        #endif
+        for (; i < vertexCount; ++i) {
+            GLfloat* v = vertices + i * FLOAT_PER_VERTEX;
+            __m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(v[0])));
+            r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+            _mm_storel_pi((__m64*)v, r);
+            v[2] = _mm_cvtss_f32(_mm_movehl_ps(r, r));
+        }
+    #else
+        GLfloat tx = m[12] + positionOffset->x, ty = m[13] + positionOffset->y, tz = m[14] + positionOffset->z;
+        for (; i < vertexCount; ++i) {
+            GLfloat* v = vertices + i * FLOAT_PER_VERTEX;
+            GLfloat x = v[0], y = v[1], z = v[2];
+            v[0] = m[0] * x + m[4] * y + m[8] * z + tx;
+            v[1] = m[1] * x + m[5] * y + m[9] * z + ty;
+            v[2] = m[2] * x + m[6] * y + m[10] * z + tz;
+        }
+    #endif
+        return;
+    }
+    // Projective matrices still divide by w per vertex
     for (size_t i = 0; i < vertexCount; i++) {
         Vec3 vertex = { vertices[i*FLOAT_PER_VERTEX], vertices[i*FLOAT_PER_VERTEX+1], vertices[i*FLOAT_PER_VERTEX+2] };
         Vec3 rotatedVertex = MatrixMultiplyVector(rotationMatrix, vertex);
@@ -147,7 +253,7 @@ void TransformVertices(GLfloat *vertices, size_t vertexCount, const GLfloat *rot
 }
 
 Vec3 Vec3Add(const Vec3 vec1, const Vec3 vec2) {
-    Vec3 result = { vec1.x + vec2.x, vec1.y + vec2.y, vec1.x + vec2.x };
+    Vec3 result = { vec1.x + vec2.x, vec1.y + vec2.y, vec1.z + vec2.z };
     return result;
 }
 
@@ -18,7 +18,7 @@ GLuint CompileShader(const char* shaderSource, GLenum type) {
     return shader;
 }
 
-const char* LoadShaderText(const char* filepath) {
+static char* ShaderReadFile(const char* filepath) {
     FILE* file = fopen(filepath, "rb");
     if (!file) {
         printf("Failed to open %s\n", filepath);
@@ -48,6 +48,7 @@ GLuint LinkShaders(const char* vertex, const char* fragment) {
     GLuint vertexShader = CompileShader(vertex, GL_VERTEX_SHADER);
     GLuint fragmentShader = CompileShader(fragment, GL_FRAGMENT_SHADER);
     GLuint program = glCreateProgram();
+    if (GLEW_ARB_get_program_binary) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
     glLinkProgram(program);
@@ -67,47 +68,733 @@ GLuint LinkShaders(const char* vertex, const char* fragment) {
     return program;
 }
 
-Shader LoadShader(const char* vertex, const char* fragment) {
-    const char* fragmentsrc = fragment;
-    const char* vertexsrc = vertex;
-    if (FileExists(vertex)) {
-        vertexsrc = LoadShaderText(vertex);
+// Shader Preprocessor
+
+const char* shaderfeatures[SHADER_FEATURES_MAX] = {"SDF", "CURSOR"};
+
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+    size_t version;        // Bytes of the leading #version line, 0 until one is found
+    int versionline;       // Source line the text after it starts at
+} ShaderBuffer;
+
+static void ShaderAppend(ShaderBuffer* out, const char* text, size_t size) {
+    if (out->length + size + 1 > out->capacity) {
+        size_t capacity = out->capacity ? out->capacity : 4096;
+        while (capacity < out->length + size + 1) capacity *= 2;
+        out->text = realloc(out->text, capacity);
+        out->capacity = capacity;
+    }
+    memcpy(out->text + out->length, text, size);
+    out->length += size;
+    out->text[out->length] = '\0';
+}
+
+static void ShaderInsert(ShaderBuffer* out, size_t offset, const char* text, size_t size) {
+    ShaderAppend(out, text, size);
+    memmove(out->text + offset + size, out->text + offset, out->length - size - offset);
+    memcpy(out->text + offset, text, size);
+}
+
+static void ShaderIncludesFree(ShaderIncludes* includes) {
+    for (int i = 0; i < includes->count; ++i) free(includes->paths[i]);
+    free(includes->paths);
+    *includes = (ShaderIncludes){0};
+}
+
+// Includes resolve next to the including file and are pulled in once
+// The first #version moves to the top wherever it came from, so a file may define features and then include the real shader
+static bool ShaderInclude(const char* filepath, ShaderIncludes* includes, int depth, ShaderBuffer* out) {
+    char* text = ShaderReadFile(filepath);
+    if (!text) return false;
+    bool ok = true;
+    int number = 1;
+    char line[64];
+    for (char* ptr = text; *ptr && ok; ++number) {
+        char* end = strchr(ptr, '\n');
+        size_t size = end ? (size_t)(end - ptr) + 1 : strlen(ptr);
+        const char* directive = ptr;
+        while (*directive == ' ' || *directive == '\t') directive++;
+        if (strncmp(directive, "#include", 8) == 0) {
+            const char* open = memchr(directive, '"', ptr + size - directive);
+            const char* close = open ? memchr(open + 1, '"', ptr + size - open - 1) : NULL;
+            if (!close) {
+                printf("Malformed #include in %s:%d\n", filepath, number);
+                ok = false;
+                break;
+            }
+            char path[PATH_MAX];
+            const char* slash = strrchr(filepath, '/');
+            snprintf(path, sizeof(path), "%.*s%.*s", slash ? (int)(slash - filepath) + 1 : 0, filepath, (int)(close - open - 1), open + 1);
+            bool seen = false;
+            for (int i = 0; i < includes->count && !seen; ++i) seen = strcmp(includes->paths[i], path) == 0;
+            if (!seen) {
+                if (depth == SHADER_INCLUDE_DEPTH) {
+                    printf("Includes nested too deep in %s\n", filepath);
+                    ok = false;
+                    break;
+                }
+                includes->paths = realloc(includes->paths, (includes->count + 1) * sizeof(char*));
+                includes->paths[includes->count++] = strdup(path);
+                ok = ShaderInclude(path, includes, depth + 1, out);
+            }
+            // Errors keep pointing at the right line of this file
+                snprintf(line, sizeof(line), "\n#line %d\n", number + 1);
+                ShaderAppend(out, line, strlen(line));
+        } else if (strncmp(directive, "#version", 8) == 0) {
+            if (out->version) {
+                ShaderAppend(out, "\n", 1); // Repeated by an include, dropped but the line count is kept
+            } else if (out->length == 0) {
+                ShaderAppend(out, ptr, size);
+                if (!end) ShaderAppend(out, "\n", 1);
+                out->version = out->length;
+                out->versionline = number + 1;
+            } else {
+                ShaderInsert(out, 0, ptr, size);
+                if (!end) ShaderInsert(out, size, "\n", 1);
+                out->version = end ? size : size + 1;
+                out->versionline = 1;
+                ShaderAppend(out, "\n", 1);
+            }
+        } else {
+            ShaderAppend(out, ptr, size);
+        }
+        ptr += size;
+    }
+    free(text);
+    return ok;
+}
+
+// The paths of every included file are added to includes when it is not NULL
+// Bit i of features defines shaderfeatures[i] right after #version, or at the very top when the file has none
+char* ShaderPreprocess(const char* filepath, unsigned int features, ShaderIncludes* includes) {
+    ShaderIncludes local = {0};
+    ShaderBuffer out = {0};
+    if (!ShaderInclude(filepath, includes ? includes : &local, 0, &out)) {
+        free(out.text);
+        out.text = NULL;
+    } else if (features) {
+        ShaderBuffer defines = {0};
+        for (int i = 0; i < SHADER_FEATURES_MAX; ++i) {
+            if (!(features & (1u << i)) || !shaderfeatures[i]) continue;
+            ShaderAppend(&defines, "#define ", 8);
+            ShaderAppend(&defines, shaderfeatures[i], strlen(shaderfeatures[i]));
+            ShaderAppend(&defines, " 1\n", 3);
+        }
+        char line[64];
+        snprintf(line, sizeof(line), "#line %d\n", out.version ? out.versionline : 1);
+        ShaderAppend(&defines, line, strlen(line));
+        ShaderInsert(&out, out.version, defines.text, defines.length);
+        free(defines.text);
+    }
+    ShaderIncludesFree(&local);
+    return out.text;
+}
+
+const char* LoadShaderText(const char* filepath) {
+    return ShaderPreprocess(filepath, 0, NULL);
+}
+
+// Uniform Locations
+
+ShaderLocations GetShaderLocations(GLuint program) {
+    return (ShaderLocations){
+        glGetUniformLocation(program, "projection"),
+        glGetUniformLocation(program, "model"),
+        glGetUniformLocation(program, "view"),
+        glGetUniformLocation(program, "iTime"),
+        glGetUniformLocation(program, "iResolution"),
+        glGetUniformLocation(program, "iMouse"),
+        glGetUniformLocation(program, "Color"),
+        glGetUniformLocation(program, "Size"),
+    };
+}
+
+static unsigned int ShaderUniformHash(const char* name) {
+    unsigned int hash = 2166136261u; // FNV-1a
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
     }
-    if (FileExists(fragment)) {
-        fragmentsrc = LoadShaderText(fragment);
+    return hash;
+}
+
+void ShaderUniformsClear(ShaderUniforms* uniforms) {
+    if (!uniforms) return;
+    for (size_t i = 0; i < uniforms->capacity; ++i) {
+        free(uniforms->slots[i].name);
     }
-    GLuint shaderProgram = LinkShaders(vertexsrc, fragmentsrc);
-    if (vertex != vertexsrc) {
-        free((void*)vertexsrc);
+    free(uniforms->slots);
+    uniforms->slots = NULL;
+    uniforms->capacity = 0;
+    uniforms->count = 0;
+}
+
+static void ShaderUniformsInsert(ShaderUniforms* uniforms, char* name, unsigned int hash, GLint location) {
+    if ((uniforms->count + 1) * 4 > uniforms->capacity * 3) {
+        ShaderUniforms grown = {0};
+        grown.capacity = uniforms->capacity ? uniforms->capacity * 2 : 16;
+        grown.slots = calloc(grown.capacity, sizeof(ShaderUniform));
+        for (size_t i = 0; i < uniforms->capacity; ++i) {
+            ShaderUniform* slot = &uniforms->slots[i];
+            if (slot->name) ShaderUniformsInsert(&grown, slot->name, slot->hash, slot->location);
+        }
+        free(uniforms->slots);
+        *uniforms = grown;
     }
-    if (fragment != fragmentsrc) {
-        free((void*)fragmentsrc);
+    size_t mask = uniforms->capacity - 1;
+    size_t i = hash & mask;
+    while (uniforms->slots[i].name) i = (i + 1) & mask;
+    uniforms->slots[i] = (ShaderUniform){name, hash, location};
+    uniforms->count++;
+}
+
+GLint GetShaderLocation(Shader shader, const char* var) {
+    if (!shader.uniforms) return glGetUniformLocation(shader.Program, var);
+    ShaderUniforms* uniforms = shader.uniforms;
+    unsigned int hash = ShaderUniformHash(var);
+    if (uniforms->capacity) {
+        size_t mask = uniforms->capacity - 1;
+        for (size_t i = hash & mask; uniforms->slots[i].name; i = (i + 1) & mask) {
+            if (uniforms->slots[i].hash == hash && strcmp(uniforms->slots[i].name, var) == 0) {
+                return uniforms->slots[i].location;
+            }
+        }
     }
-    return (Shader){shaderProgram, vertex, fragment};
+    GLint location = glGetUniformLocation(shader.Program, var);
+    ShaderUniformsInsert(uniforms, strdup(var), hash, location);
+    return location;
 }
 
-Shader ShaderHotReload(Shader shader){
-    time_t currentVertexModTime = GetFileModTime(shader.vertex);
-    time_t currentFragmentModTime = GetFileModTime(shader.fragment);
-    if (currentVertexModTime != shader.lastvertmodtime || currentFragmentModTime != shader.lastfragmodtime) {
-        glDeleteProgram(shader.Program);
-        shader = LoadShader(shader.vertex,shader.fragment);
-        shader.lastvertmodtime = currentVertexModTime;
-        shader.lastfragmodtime = currentFragmentModTime;
+// Program Cache
+
+#define PROGRAM_CACHE_MAGIC 0x4E475250 // "PRGN"
+#define PROGRAM_CACHE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;          // Sources, renderer and driver version, a mismatch relinks from source
+    uint32_t format;
+    uint32_t size;
+} ProgramCacheHeader;
+
+typedef struct {
+    const char* dir;
+    bool enabled;
+    int hits;
+    int misses;
+    int rejected;          // Binaries the driver refused, usually after a driver update
+} ProgramCache;
+
+ProgramCache programcache = {".cache", false, 0, 0, 0};
+
+static uint64_t ProgramCacheKey(const char* vertexsrc, const char* fragmentsrc) {
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    uint64_t key = 14695981039346656037ull;
+    // Lengths go in too, so moving text between the stages changes the key
+        size_t lengths[] = {strlen(vertexsrc), strlen(fragmentsrc)};
+        key = Hash64(lengths, sizeof(lengths), key);
+        key = Hash64(vertexsrc, lengths[0], key);
+        key = Hash64(fragmentsrc, lengths[1], key);
+    if (renderer) key = Hash64(renderer, strlen(renderer) + 1, key);
+    if (version) key = Hash64(version, strlen(version) + 1, key);
+    return key;
+}
+
+static void ProgramCachePath(char* path, size_t size, uint64_t key) {
+    snprintf(path, size, "%s/%016llx.gprg", programcache.dir, (unsigned long long)key);
+}
+
+static GLuint ProgramCacheLoad(uint64_t key) {
+    char path[PATH_MAX];
+    ProgramCachePath(path, sizeof(path), key);
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    ProgramCacheHeader header;
+    void* binary = NULL;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1;
+    valid = valid && header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION && header.key == key && header.size > 0;
+    if (valid) {
+        binary = malloc(header.size);
+        valid = fread(binary, 1, header.size, file) == header.size;
+    }
+    fclose(file);
+    if (!valid) {
+        free(binary);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary, header.size);
+    free(binary);
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        programcache.rejected++;
+        return 0;
+    }
+    return program;
+}
+
+static void ProgramCacheStore(uint64_t key, GLuint program) {
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) return;
+    void* binary = malloc(size);
+    GLenum format;
+    glGetProgramBinary(program, size, &size, &format, binary);
+    char path[PATH_MAX];
+    ProgramCachePath(path, sizeof(path), key);
+    // Renamed into place once complete, a second process never reads a half written binary
+        mkdir(programcache.dir, 0755);
+        char temp[PATH_MAX];
+        snprintf(temp, sizeof(temp), "%s.%d.tmp", path, (int)getpid());
+        FILE* file = fopen(temp, "wb");
+        if (!file) {
+            printf("Failed to write program cache %s\n", path);
+            free(binary);
+            return;
+        }
+    ProgramCacheHeader header = {PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, key, format, size};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(binary, 1, size, file) == (size_t)size;
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temp, path) != 0) {
+        printf("Failed to write program cache %s\n", path);
+        unlink(temp);
     }
+    free(binary);
+}
+
+// Shader Loading
+
+static void ShaderBindFrame(GLuint program) {
+    GLuint frameBlock = program ? glGetUniformBlockIndex(program, "Frame") : GL_INVALID_INDEX;
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, frameBlock, FRAME_UNIFORMS_BINDING);
+    }
+}
+
+// Paths are read from disk, anything else is taken as the source itself
+static const char* ShaderText(const char* source, unsigned int features) {
+    return FileExists(source) ? ShaderPreprocess(source, features, NULL) : source;
+}
+
+static void ShaderTextFree(const char* text, const char* source) {
+    if (text && text != source) free((void*)text);
+}
+
+// Shader Registry
+
+typedef struct {
+    Shader* shaders;       // Latest locations of every hot reloaded shader, the program names never change
+    size_t count;
+    size_t capacity;
+    int reloads;
+    int failures;
+} ShaderRegistry;
+
+ShaderRegistry shaderregistry = {0};
+
+typedef struct {
+    uint64_t hash;
+    const char* vertex;
+    const char* fragment;
+    unsigned int features;
+    Shader shader;
+} ShaderVariant;
+
+typedef struct {
+    ShaderVariant* slots;      // Open addressing, empty slots have no vertex
+    size_t capacity;
+    size_t count;
+} ShaderVariants;
+
+ShaderVariants shadervariants = {0};
+
+// Async Compilation
+
+typedef struct {
+    GLuint program;
+    GLuint vertex, fragment;   // Stage objects, kept until the link result is read back
+    Shader* target;            // Receives the program and its locations once linked, NULL for hot reloads
+    int reload;                // 1 + shader registry index for hot reloads
+    uint64_t key;              // Program cache entry to write, 0 when the cache is off
+    unsigned long frame;       // ShaderFrame count when the job was issued
+} ShaderJob;
+
+typedef struct {
+    ShaderJob* jobs;
+    size_t count;
+    size_t capacity;
+    bool parallel;             // Completion can be polled without blocking
+    unsigned long frame;       // ShaderFrame calls so far
+} ShaderCompiler;
+
+ShaderCompiler shadercompiler = {0};
+
+void ShaderCompilerInit(void) {
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        shadercompiler.parallel = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        shadercompiler.parallel = true;
+    }
+}
+
+// Issues both compiles and the link without reading any status back, the driver is free to run them on its own threads
+static void ShaderJobStart(ShaderJob* job, const char* vertexsrc, const char* fragmentsrc) {
+    job->program = glCreateProgram();
+    if (GLEW_ARB_get_program_binary) glProgramParameteri(job->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    job->vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(job->vertex, 1, &vertexsrc, NULL);
+    glCompileShader(job->vertex);
+    job->fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(job->fragment, 1, &fragmentsrc, NULL);
+    glCompileShader(job->fragment);
+    glAttachShader(job->program, job->vertex);
+    glAttachShader(job->program, job->fragment);
+    glLinkProgram(job->program);
+    job->frame = shadercompiler.frame;
+    if (shadercompiler.count == shadercompiler.capacity) {
+        shadercompiler.capacity = shadercompiler.capacity ? shadercompiler.capacity * 2 : 16;
+        shadercompiler.jobs = realloc(shadercompiler.jobs, shadercompiler.capacity * sizeof(ShaderJob));
+    }
+    shadercompiler.jobs[shadercompiler.count++] = *job;
+}
+
+static bool ShaderJobLinked(ShaderJob* job) {
+    GLint success;
+    char infoLog[512];
+    GLuint stages[] = {job->vertex, job->fragment};
+    for (int i = 0; i < 2; ++i) {
+        glGetShaderiv(stages[i], GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(stages[i], 512, NULL, infoLog);
+            printf("ERROR::SHADER::COMPILATION_FAILED\n%s\n", infoLog);
+            return false;
+        }
+    }
+    glGetProgramiv(job->program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(job->program, 512, NULL, infoLog);
+        printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+    }
+    return success;
+}
+
+// Moves the new executable under the registered program name so every by-value copy of the shader stays valid
+static bool ShaderJobSwap(ShaderJob* job, GLuint program) {
+    GLint success = 0;
+    if (GLEW_ARB_get_program_binary) {
+        GLint size = 0;
+        glGetProgramiv(job->program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size > 0) {
+            void* binary = malloc(size);
+            GLenum format;
+            glGetProgramBinary(job->program, size, &size, &format, binary);
+            glProgramBinary(program, format, binary, size);
+            free(binary);
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+        }
+    }
+    // No binary support, the compiled stages are linked again under the old name
+        if (!success) {
+            glAttachShader(program, job->vertex);
+            glAttachShader(program, job->fragment);
+            glLinkProgram(program);
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            glDetachShader(program, job->vertex);
+            glDetachShader(program, job->fragment);
+        }
+    return success;
+}
+
+static void ShaderJobFinish(ShaderJob* job) {
+    bool linked = ShaderJobLinked(job);
+    glDetachShader(job->program, job->vertex);
+    glDetachShader(job->program, job->fragment);
+    if (job->reload) {
+        Shader* shader = &shaderregistry.shaders[job->reload - 1];
+        if (shader->Program) { // Deleted while the reload was compiling
+            if (linked) {
+                BatchFlush(); // Queued draws were recorded against the old program
+                linked = ShaderJobSwap(job, shader->Program);
+            }
+            if (linked) {
+                ShaderBindFrame(shader->Program);
+                // The uniform table is shared by every copy of the shader, so it is emptied in place
+                    shader->locations = GetShaderLocations(shader->Program);
+                    ShaderUniformsClear(shader->uniforms);
+                shaderregistry.reloads++;
+            } else {
+                printf("Keeping the previous program, %s / %s failed to build\n", shader->vertex, shader->fragment);
+                shaderregistry.failures++;
+            }
+        }
+        glDeleteProgram(job->program);
+    } else {
+        if (linked) {
+            ShaderBindFrame(job->program);
+            if (job->key) ProgramCacheStore(job->key, job->program);
+        } else {
+            glDeleteProgram(job->program);
+            job->program = 0;
+        }
+        if (job->target) {
+            job->target->Program = job->program;
+            job->target->locations = job->program ? GetShaderLocations(job->program) : (ShaderLocations){-1, -1, -1, -1, -1, -1, -1, -1};
+        }
+    }
+    glDeleteShader(job->vertex);
+    glDeleteShader(job->fragment);
+}
+
+static void ShaderJobRemove(size_t index) {
+    ShaderJob job = shadercompiler.jobs[index];
+    shadercompiler.jobs[index] = shadercompiler.jobs[--shadercompiler.count];
+    ShaderJobFinish(&job);
+}
+
+// Called once per frame, jobs issued this frame are left for the next one so the driver gets at least a swap to work on them
+// Without parallel compile support the status read on that next frame can still block until the link is done
+void ShaderFrame(void) {
+    for (size_t i = 0; i < shadercompiler.count;) {
+        GLint done = shadercompiler.jobs[i].frame != shadercompiler.frame;
+        if (done && shadercompiler.parallel) glGetProgramiv(shadercompiler.jobs[i].program, GL_COMPLETION_STATUS_KHR, &done);
+        if (done) {
+            ShaderJobRemove(i);
+        } else {
+            ++i;
+        }
+    }
+    shadercompiler.frame++;
+}
+
+bool ShaderReady(Shader shader) {
+    for (size_t i = 0; i < shadercompiler.count; ++i) {
+        if (!shadercompiler.jobs[i].reload && shadercompiler.jobs[i].program == shader.Program) return false;
+    }
+    return shader.Program != 0;
+}
+
+// Blocks until the shader is linked
+void ShaderWait(Shader* shader) {
+    for (size_t i = 0; i < shadercompiler.count; ++i) {
+        if (!shadercompiler.jobs[i].reload && shadercompiler.jobs[i].program == shader->Program) {
+            shadercompiler.jobs[i].target = shader;
+            ShaderJobRemove(i);
+            return;
+        }
+    }
+}
+
+void ShaderCompilerTerminate(void) {
+    while (shadercompiler.count) ShaderJobRemove(shadercompiler.count - 1);
+    free(shadercompiler.jobs);
+    shadercompiler = (ShaderCompiler){0};
+}
+
+// Reserves the program name right away, a cached binary is ready at once, anything else links in the background
+static Shader ShaderLoadStart(const char* vertex, const char* fragment, unsigned int features, Shader* target) {
+    Shader shader = {0, vertex, fragment, features};
+    shader.locations = (ShaderLocations){-1, -1, -1, -1, -1, -1, -1, -1};
+    shader.uniforms = calloc(1, sizeof(ShaderUniforms));
+    const char* vertexsrc = ShaderText(vertex, features);
+    const char* fragmentsrc = ShaderText(fragment, features);
+    if (vertexsrc && fragmentsrc) {
+        // Linked binary from an earlier run, compiled from source when missing or refused
+            uint64_t key = 0;
+            GLint formats = 0;
+            if (programcache.enabled && GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            if (formats > 0) {
+                key = ProgramCacheKey(vertexsrc, fragmentsrc);
+                shader.Program = ProgramCacheLoad(key);
+                if (shader.Program) programcache.hits++; else programcache.misses++;
+            }
+        if (shader.Program) {
+            ShaderBindFrame(shader.Program);
+            shader.locations = GetShaderLocations(shader.Program);
+        } else {
+            ShaderJob job = {0};
+            job.target = target;
+            job.key = key;
+            ShaderJobStart(&job, vertexsrc, fragmentsrc);
+            shader.Program = job.program;
+        }
+    }
+    ShaderTextFree(vertexsrc, vertex);
+    ShaderTextFree(fragmentsrc, fragment);
     return shader;
 }
 
+GLuint LoadShaderProgram(const char* vertex, const char* fragment) {
+    Shader shader = ShaderLoadStart(vertex, fragment, 0, NULL);
+    ShaderWait(&shader);
+    free(shader.uniforms);
+    return shader.Program;
+}
+
+Shader LoadShader(const char* vertex, const char* fragment) {
+    Shader shader = ShaderLoadStart(vertex, fragment, 0, NULL);
+    ShaderWait(&shader);
+    return shader;
+}
+
+// The shader is written again when its link finishes, keep it in place and draw with it once ShaderReady says so
+void LoadShaderAsync(Shader* shader, const char* vertex, const char* fragment) {
+    *shader = ShaderLoadStart(vertex, fragment, 0, shader);
+}
+
+// Hot Reload
+
+// Compiles the edit on a side program, the running one keeps drawing until ShaderFrame swaps it in
+static void ShaderRegistryReload(const char* path, void* user) {
+    intptr_t index = (intptr_t)user;
+    Shader* shader = &shaderregistry.shaders[index];
+    const char* vertexsrc = ShaderText(shader->vertex, shader->features);
+    const char* fragmentsrc = ShaderText(shader->fragment, shader->features);
+    if (vertexsrc && fragmentsrc) {
+        ShaderJob job = {0};
+        job.reload = index + 1;
+        ShaderJobStart(&job, vertexsrc, fragmentsrc);
+    } else {
+        shaderregistry.failures++;
+    }
+    ShaderTextFree(vertexsrc, shader->vertex);
+    ShaderTextFree(fragmentsrc, shader->fragment);
+}
+
+// Shaders are found by program name, which a reload never changes, a handful of them makes a scan cheap
+static int ShaderRegistryFind(GLuint program) {
+    for (size_t i = 0; i < shaderregistry.count; ++i) {
+        if (shaderregistry.shaders[i].Program == program) return (int)i;
+    }
+    return -1;
+}
+
+// Shaders without files on disk are registered too, so they are only looked at once
+static int ShaderRegistryAdd(Shader shader) {
+    if (shaderregistry.count == shaderregistry.capacity) {
+        shaderregistry.capacity = shaderregistry.capacity ? shaderregistry.capacity * 2 : 16;
+        shaderregistry.shaders = realloc(shaderregistry.shaders, shaderregistry.capacity * sizeof(Shader));
+    }
+    intptr_t index = shaderregistry.count++;
+    shaderregistry.shaders[index] = shader;
+    bool vertexfile = FileExists(shader.vertex);
+    bool fragmentfile = FileExists(shader.fragment);
+    // Sources and everything they include
+        ShaderIncludes includes = {0};
+        if (vertexfile) {
+            WatchFile(shader.vertex, ShaderRegistryReload, (void*)index);
+            free(ShaderPreprocess(shader.vertex, shader.features, &includes));
+        }
+        if (fragmentfile && strcmp(shader.vertex, shader.fragment) != 0) {
+            WatchFile(shader.fragment, ShaderRegistryReload, (void*)index);
+            free(ShaderPreprocess(shader.fragment, shader.features, &includes));
+        }
+        for (int i = 0; i < includes.count; ++i) WatchFile(includes.paths[i], ShaderRegistryReload, (void*)index);
+        ShaderIncludesFree(&includes);
+    return (int)index;
+}
+
+// Registers the shader with the asset watcher the first time, afterwards only hands back the latest locations
+Shader ShaderHotReload(Shader shader){
+    if (!shader.Program) return shader;
+    int index = ShaderRegistryFind(shader.Program);
+    if (index < 0) index = ShaderRegistryAdd(shader);
+    Shader current = shaderregistry.shaders[index];
+    current.hotreloading = shader.hotreloading;
+    return current;
+}
+
+void ShaderRegistryTerminate(void) {
+    free(shaderregistry.shaders);
+    shaderregistry = (ShaderRegistry){0};
+}
+
 void DeleteShader(Shader shader) {
-    glDeleteProgram(shader.Program);
+    intptr_t index = shader.Program ? ShaderRegistryFind(shader.Program) : -1;
+    if (index >= 0) {
+        UnwatchFiles((void*)index);
+        shaderregistry.shaders[index] = (Shader){0};
+    }
+    StateDeleteProgram(shader.Program);
+    ShaderUniformsClear(shader.uniforms);
+    free(shader.uniforms);
+}
+
+// Shader Variants
+
+static uint64_t ShaderVariantHash(const char* vertex, const char* fragment, unsigned int features) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = Hash64(vertex, strlen(vertex) + 1, hash);
+    hash = Hash64(fragment, strlen(fragment) + 1, hash);
+    return Hash64(&features, sizeof(features), hash);
+}
+
+static void ShaderVariantsGrow(void) {
+    ShaderVariants grown = {0};
+    grown.capacity = shadervariants.capacity ? shadervariants.capacity * 2 : 16;
+    grown.slots = calloc(grown.capacity, sizeof(ShaderVariant));
+    for (size_t i = 0; i < shadervariants.capacity; ++i) {
+        ShaderVariant* variant = &shadervariants.slots[i];
+        if (!variant->vertex) continue;
+        size_t j = variant->hash & (grown.capacity - 1);
+        while (grown.slots[j].vertex) j = (j + 1) & (grown.capacity - 1);
+        grown.slots[j] = *variant;
+    }
+    grown.count = shadervariants.count;
+    free(shadervariants.slots);
+    shadervariants = grown;
+}
+
+// Each (vertex, fragment, features) permutation is compiled once, the cache owns the returned shader
+Shader GetShaderVariant(const char* vertex, const char* fragment, unsigned int features) {
+    uint64_t hash = ShaderVariantHash(vertex, fragment, features);
+    if (shadervariants.capacity) {
+        size_t mask = shadervariants.capacity - 1;
+        for (size_t i = hash & mask; shadervariants.slots[i].vertex; i = (i + 1) & mask) {
+            ShaderVariant* variant = &shadervariants.slots[i];
+            if (variant->hash == hash && variant->features == features && strcmp(variant->vertex, vertex) == 0 && strcmp(variant->fragment, fragment) == 0) {
+                return variant->shader;
+            }
+        }
+    }
+    if ((shadervariants.count + 1) * 4 > shadervariants.capacity * 3) ShaderVariantsGrow();
+    ShaderVariant variant = {hash, strdup(vertex), strdup(fragment), features};
+    variant.shader = ShaderLoadStart(variant.vertex, variant.fragment, features, NULL);
+    ShaderWait(&variant.shader);
+    size_t mask = shadervariants.capacity - 1;
+    size_t i = hash & mask;
+    while (shadervariants.slots[i].vertex) i = (i + 1) & mask;
+    shadervariants.slots[i] = variant;
+    shadervariants.count++;
+    return variant.shader;
+}
+
+void ShaderVariantsClear(void) {
+    for (size_t i = 0; i < shadervariants.capacity; ++i) {
+        ShaderVariant* variant = &shadervariants.slots[i];
+        if (!variant->vertex) continue;
+        DeleteShader(variant->shader);
+        free((void*)variant->vertex);
+        free((void*)variant->fragment);
+    }
+    free(shadervariants.slots);
+    shadervariants = (ShaderVariants){0};
 }
 
 // OpenGl Utils
 
 void UnbindTexture(){
-    glDisable(GL_BLEND);
-    glDisable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    StateEnable(GL_BLEND, false);
+    StateBindTexture(0);
 }
 
 void glTexOpt(GLint filter,GLint warp){
@@ -115,29 +802,40 @@ void glTexOpt(GLint filter,GLint warp){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, warp);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, warp);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 } 
 
 GLint GLuint1i(Shader shader, const char* var,float in){
-    glUniform1i(glGetUniformLocation(shader.Program, var), in);
+    GLint location = GetShaderLocation(shader, var);
+    glUniform1i(location, in);
+    return location;
 }
 
 GLint GLuint1f(Shader shader, const char* var,float in){
-    glUniform1f(glGetUniformLocation(shader.Program, var), in);
+    GLint location = GetShaderLocation(shader, var);
+    glUniform1f(location, in);
+    return location;
 }
 
 GLint GLuint2f(Shader shader, const char* var,float in1,float in2){
-    glUniform2f(glGetUniformLocation(shader.Program, var), in1, in2);
+    GLint location = GetShaderLocation(shader, var);
+    glUniform2f(location, in1, in2);
+    return location;
 }
 
 GLint GLuint3f(Shader shader, const char* var,float in1,float in2,float in3){
-    glUniform3f(glGetUniformLocation(shader.Program, var), in1, in2, in3);
+    GLint location = GetShaderLocation(shader, var);
+    glUniform3f(location, in1, in2, in3);
+    return location;
 }
 
 GLint GLuint4f(Shader shader, const char* var,float in1,float in2,float in3,float in4){
-    glUniform4f(glGetUniformLocation(shader.Program, var), in1, in2, in3, in4);
+    GLint location = GetShaderLocation(shader, var);
+    glUniform4f(location, in1, in2, in3, in4);
+    return location;
 }
 
 GLint GLumatrix4fv(Shader shader, const char* var,GLfloat* in){
-    glUniformMatrix4fv(glGetUniformLocation(shader.Program, var), 1, GL_FALSE, in);
+    GLint location = GetShaderLocation(shader, var);
+    glUniformMatrix4fv(location, 1, GL_FALSE, in);
+    return location;
 }
@@ -0,0 +1,161 @@
+// GL State Tracker
+
+#define STATE_UNKNOWN 0xFFFFFFFFu
+
+typedef struct {
+    int issued;
+    int skipped;
+} StateStats;
+
+typedef struct {
+    GLuint program;
+    GLuint vertexarray;
+    GLuint arraybuffer;
+    GLuint elementbuffer;
+    GLuint uniformbuffer;
+    GLuint texture;
+    GLuint blend;
+    GLenum blendsrc;
+    GLenum blenddst;
+    GLuint depth;
+    GLenum depthfunc;
+    GLuint cull;
+    GLenum cullface;
+    GLenum frontface;
+    GLenum polygonmode;
+    StateStats frame;
+    StateStats stats;
+} GLState;
+
+GLState glstate = {
+    0, 0, 0, 0, 0, 0,              // Program, VAO, Buffers, Texture
+    GL_FALSE, GL_ONE, GL_ZERO,     // Blend
+    GL_FALSE, GL_LESS,             // Depth
+    GL_FALSE, GL_BACK, GL_CCW,     // Cull
+    GL_FILL                        // Polygon mode
+};
+
+static bool StateChanged(GLuint* current, GLuint value) {
+    if (*current == value) {
+        glstate.frame.skipped++;
+        return false;
+    }
+    *current = value;
+    glstate.frame.issued++;
+    return true;
+}
+
+void StateUseProgram(GLuint program) {
+    if (StateChanged(&glstate.program, program)) glUseProgram(program);
+}
+
+void StateBindVertexArray(GLuint vao) {
+    if (StateChanged(&glstate.vertexarray, vao)) {
+        glBindVertexArray(vao);
+        glstate.elementbuffer = STATE_UNKNOWN; // element buffer binding belongs to the VAO
+    }
+}
+
+void StateBindBuffer(GLenum target, GLuint buffer) {
+    GLuint* current = NULL;
+    switch (target) {
+        case GL_ARRAY_BUFFER:         current = &glstate.arraybuffer; break;
+        case GL_ELEMENT_ARRAY_BUFFER: current = &glstate.elementbuffer; break;
+        case GL_UNIFORM_BUFFER:       current = &glstate.uniformbuffer; break;
+    }
+    if (!current) {
+        glBindBuffer(target, buffer);
+        glstate.frame.issued++;
+    } else if (StateChanged(current, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void StateBindTexture(GLuint texture) {
+    if (StateChanged(&glstate.texture, texture)) glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void StateEnable(GLenum cap, bool enable) {
+    GLuint* current = NULL;
+    switch (cap) {
+        case GL_BLEND:      current = &glstate.blend; break;
+        case GL_DEPTH_TEST: current = &glstate.depth; break;
+        case GL_CULL_FACE:  current = &glstate.cull; break;
+    }
+    if (current && !StateChanged(current, enable ? GL_TRUE : GL_FALSE)) return;
+    if (!current) glstate.frame.issued++;
+    if (enable) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void StateBlendFunc(GLenum src, GLenum dst) {
+    if (glstate.blendsrc == src && glstate.blenddst == dst) {
+        glstate.frame.skipped++;
+        return;
+    }
+    glstate.blendsrc = src;
+    glstate.blenddst = dst;
+    glstate.frame.issued++;
+    glBlendFunc(src, dst);
+}
+
+void StateDepthFunc(GLenum func) {
+    if (StateChanged(&glstate.depthfunc, func)) glDepthFunc(func);
+}
+
+void StateCullFace(GLenum face) {
+    if (StateChanged(&glstate.cullface, face)) glCullFace(face);
+}
+
+void StateFrontFace(GLenum face) {
+    if (StateChanged(&glstate.frontface, face)) glFrontFace(face);
+}
+
+void StatePolygonMode(GLenum mode) {
+    if (StateChanged(&glstate.polygonmode, mode)) glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+// Deleting a bound object makes GL fall back to 0, so the shadow copy has to follow
+
+void StateDeleteProgram(GLuint program) {
+    if (glstate.program == program) glstate.program = STATE_UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void StateDeleteVertexArray(GLuint vao) {
+    if (glstate.vertexarray == vao) {
+        glstate.vertexarray = 0;
+        glstate.elementbuffer = STATE_UNKNOWN;
+    }
+    glDeleteVertexArrays(1, &vao);
+}
+
+void StateDeleteBuffer(GLuint buffer) {
+    if (glstate.arraybuffer == buffer) glstate.arraybuffer = 0;
+    if (glstate.elementbuffer == buffer) glstate.elementbuffer = 0;
+    if (glstate.uniformbuffer == buffer) glstate.uniformbuffer = 0;
+    glDeleteBuffers(1, &buffer);
+}
+
+void StateDeleteTexture(GLuint texture) {
+    if (glstate.texture == texture) glstate.texture = 0;
+    glDeleteTextures(1, &texture);
+}
+
+// Call after touching GL state behind the tracker's back
+
+void StateReset(void) {
+    StateStats frame = glstate.frame;
+    StateStats stats = glstate.stats;
+    memset(&glstate, 0xFF, sizeof(GLState));
+    glstate.frame = frame;
+    glstate.stats = stats;
+}
+
+void StateFrame(void) {
+    glstate.stats = glstate.frame;
+    glstate.frame = (StateStats){0};
+}
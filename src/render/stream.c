@@ -0,0 +1,129 @@
+// Streaming Ring Buffer
+
+#define STREAM_REGIONS 3
+
+typedef struct {
+    GLenum target;
+    GLuint buffer;
+    GLsizeiptr size;       // Bytes per region
+    GLsizeiptr offset;     // Write head inside the current region
+    GLsizeiptr used;       // Bytes written this frame
+    GLsizeiptr peak;       // Most bytes written in a single frame
+    int region;
+    int generation;        // Bumped whenever the buffer object is replaced
+    bool persistent;
+    void* mapped;
+    GLsync fences[STREAM_REGIONS];
+} StreamBuffer;
+
+StreamBuffer streamvertex = {0};
+StreamBuffer streamindex = {0};
+StreamBuffer streamunpack = {0}; // Pixel uploads, created by the first async image
+
+static void StreamAllocate(StreamBuffer* stream, GLsizeiptr size) {
+    if (stream->buffer) StateDeleteBuffer(stream->buffer);
+    for (int i = 0; i < STREAM_REGIONS; ++i) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+        stream->fences[i] = NULL;
+    }
+    stream->size = size;
+    stream->offset = 0;
+    stream->region = 0;
+    stream->generation++;
+    stream->persistent = GLEW_ARB_buffer_storage;
+    glGenBuffers(1, &stream->buffer);
+    StateBindBuffer(stream->target, stream->buffer);
+    if (stream->persistent) {
+        // Map once and keep writing through the pointer, fences keep the GPU and CPU apart
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(stream->target, size * STREAM_REGIONS, NULL, flags);
+            stream->mapped = glMapBufferRange(stream->target, 0, size * STREAM_REGIONS, flags);
+            if (!stream->mapped) {
+                printf("Failed to map streaming buffer, falling back to orphaning\n");
+                StateDeleteBuffer(stream->buffer);
+                glGenBuffers(1, &stream->buffer);
+                StateBindBuffer(stream->target, stream->buffer);
+                stream->persistent = false;
+            }
+    }
+    if (!stream->persistent) {
+        stream->mapped = NULL;
+        glBufferData(stream->target, size * STREAM_REGIONS, NULL, GL_STREAM_DRAW);
+    }
+}
+
+void StreamInit(StreamBuffer* stream, GLenum target, GLsizeiptr size) {
+    stream->target = target;
+    StreamAllocate(stream, size);
+}
+
+// Copies data into the ring and returns its byte offset inside stream->buffer, which is left bound
+GLintptr StreamUpload(StreamBuffer* stream, const void* data, GLsizeiptr size, GLsizeiptr align) {
+    StateBindBuffer(stream->target, stream->buffer);
+    if (size <= 0) return 0;
+    GLsizeiptr capacity = stream->persistent ? stream->size : stream->size * STREAM_REGIONS;
+    GLsizeiptr base = stream->persistent ? stream->region * stream->size : 0;
+    GLsizeiptr pad = (align - (base + stream->offset) % align) % align;
+    if (stream->offset + pad + size > capacity) {
+        if (stream->persistent || size > capacity) {
+            // Grow to fit what a frame really uses, the old store lives on until its draws retire
+                GLsizeiptr grow = stream->size;
+                while (grow < (stream->used + size + align) * 2) grow *= 2;
+                StreamAllocate(stream, grow);
+        } else {
+            // Orphan the store instead of waiting on draws that still read it
+                glBufferData(stream->target, capacity, NULL, GL_STREAM_DRAW);
+                stream->offset = 0;
+        }
+        base = 0;
+        pad = 0;
+    }
+    GLintptr offset = base + stream->offset + pad;
+    if (stream->persistent) {
+        memcpy((char*)stream->mapped + offset, data, size);
+    } else {
+        void* dst = glMapBufferRange(stream->target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (dst) {
+            memcpy(dst, data, size);
+            glUnmapBuffer(stream->target);
+        } else {
+            glBufferSubData(stream->target, offset, size, data);
+        }
+    }
+    stream->offset += pad + size;
+    stream->used += pad + size;
+    return offset;
+}
+
+static void StreamAdvance(StreamBuffer* stream) {
+    if (stream->used > stream->peak) stream->peak = stream->used;
+    stream->used = 0;
+    if (!stream->buffer || !stream->persistent) return;
+    // Fence the region the GPU is about to read, then wait for the oldest one to be free again
+        stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stream->region = (stream->region + 1) % STREAM_REGIONS;
+        stream->offset = 0;
+        GLsync fence = stream->fences[stream->region];
+        if (fence) {
+            GLenum result;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+            glDeleteSync(fence);
+            stream->fences[stream->region] = NULL;
+        }
+}
+
+void StreamFrame(void) {
+    StreamAdvance(&streamvertex);
+    StreamAdvance(&streamindex);
+    StreamAdvance(&streamunpack);
+}
+
+void StreamTerminate(StreamBuffer* stream) {
+    for (int i = 0; i < STREAM_REGIONS; ++i) {
+        if (stream->fences[i]) glDeleteSync(stream->fences[i]);
+    }
+    if (stream->buffer) StateDeleteBuffer(stream->buffer);
+    *stream = (StreamBuffer){0};
+}
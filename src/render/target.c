@@ -0,0 +1,174 @@
+// Render Targets
+
+#define RENDER_TARGET_STACK 8
+
+typedef struct {
+    GLuint framebuffer;
+    GLuint texture;
+    GLuint depth;          // Depth-stencil renderbuffer, 0 when the target has none
+    int width, height;
+    bool nearest;
+} RenderTarget;
+
+static RenderTarget targetstack[RENDER_TARGET_STACK];
+static int targetdepth = 0;
+
+RenderTarget LoadRenderTarget(int width, int height, bool depth, bool nearest) {
+    RenderTarget target = {0};
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    target.width = width;
+    target.height = height;
+    target.nearest = nearest;
+    // Color texture, sampled later like any Img
+        glGenTextures(1, &target.texture);
+        StateBindTexture(target.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexOpt(nearest ? GL_NEAREST : GL_LINEAR, GL_CLAMP_TO_EDGE);
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    if (depth) {
+        glGenRenderbuffers(1, &target.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) printf("Render target %dx%d is incomplete\n", width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetdepth ? targetstack[targetdepth - 1].framebuffer : window.framebuffer);
+    return target;
+}
+
+static void RenderTargetApply(void) {
+    if (targetdepth) {
+        RenderTarget* target = &targetstack[targetdepth - 1];
+        glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+        glViewport(0, 0, target->width, target->height);
+        SetFrameResolution(target->width, target->height);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, window.framebuffer);
+        glViewport(0, 0, window.screen_width, window.screen_height);
+        SetFrameResolution(0, 0);
+    }
+}
+
+// Draws keep using window coordinates, a target smaller than the window simply renders them at lower resolution
+void BeginRenderTarget(RenderTarget target) {
+    if (targetdepth == RENDER_TARGET_STACK) {
+        printf("Render target stack is full\n");
+        return;
+    }
+    BatchFlush();
+    targetstack[targetdepth++] = target;
+    RenderTargetApply();
+}
+
+void EndRenderTarget(void) {
+    if (targetdepth == 0) return;
+    BatchFlush();
+    targetdepth--;
+    RenderTargetApply();
+}
+
+void ClearRenderTarget(Color color) {
+    BatchFlush();
+    GLfloat previous[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, previous);
+    glClearColor(color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(previous[0], previous[1], previous[2], previous[3]);
+}
+
+// Rows come out bottom first like LoadImage, so the result draws upright with DrawImage
+Img RenderTargetImage(RenderTarget target) {
+    Img img = {0};
+    img.raw = target.texture;
+    img.width = target.width;
+    img.height = target.height;
+    img.channels = 4;
+    return img;
+}
+
+void UnloadRenderTarget(RenderTarget target) {
+    BatchFlush();
+    glDeleteFramebuffers(1, &target.framebuffer);
+    StateDeleteTexture(target.texture);
+    if (target.depth) glDeleteRenderbuffers(1, &target.depth);
+}
+
+// Post Processing
+
+#define POST_MAX_PASSES 8
+
+typedef struct {
+    Shader shader;
+    float scale;           // Resolution relative to the window, 0.5 runs the pass at half size
+    RenderTarget target;
+} PostPass;
+
+typedef struct {
+    RenderTarget scene;    // Everything drawn between BeginPostProcess and EndPostProcess
+    PostPass passes[POST_MAX_PASSES];
+    int count;
+    int width, height;     // Window size the targets were made for
+} PostProcess;
+
+void AddPostPass(PostProcess* post, Shader shader, float scale) {
+    if (post->count == POST_MAX_PASSES) {
+        printf("Post process chain is full\n");
+        return;
+    }
+    if (scale <= 0.0f) scale = 1.0f;
+    post->passes[post->count++] = (PostPass){shader, scale};
+    post->width = 0; // Rebuild the targets, the previous last pass now needs one
+}
+
+static void PostProcessResize(PostProcess* post) {
+    if (post->width == window.screen_width && post->height == window.screen_height && post->scene.framebuffer) return;
+    post->width = window.screen_width;
+    post->height = window.screen_height;
+    if (post->scene.framebuffer) UnloadRenderTarget(post->scene);
+    post->scene = LoadRenderTarget(post->width, post->height, true, false);
+    // The last pass draws straight into whatever was bound before, it needs no target
+        for (int i = 0; i < post->count - 1; ++i) {
+            PostPass* pass = &post->passes[i];
+            if (pass->target.framebuffer) UnloadRenderTarget(pass->target);
+            pass->target = LoadRenderTarget(post->width * pass->scale, post->height * pass->scale, false, false);
+        }
+}
+
+// The scene starts opaque black, translucent draws blend over it once instead of leaving a squared alpha behind
+void BeginPostProcess(PostProcess* post) {
+    PostProcessResize(post);
+    BeginRenderTarget(post->scene);
+    ClearRenderTarget((Color){0, 0, 0, 255});
+}
+
+// Runs each pass over the previous result as a full screen quad, scaled passes are upsampled by the next one
+void EndPostProcess(PostProcess* post) {
+    EndRenderTarget();
+    int blendmode = batch.blendmode;
+    Img input = RenderTargetImage(post->scene);
+    // Intermediate passes replace their target, blending would mix in what the pass drew last frame
+        BatchBlendMode(BLEND_NONE);
+        for (int i = 0; i < post->count - 1; ++i) {
+            PostPass* pass = &post->passes[i];
+            BeginRenderTarget(pass->target);
+            DrawImageShader(input, 0, 0, window.screen_width, window.screen_height, 0.0f, pass->shader);
+            EndRenderTarget();
+            input = RenderTargetImage(pass->target);
+        }
+    // The targets hold colors already weighted by their alpha, the composite must not weight them again
+        BatchBlendMode(BLEND_PREMULTIPLIED);
+        DrawImageShader(input, 0, 0, window.screen_width, window.screen_height, 0.0f, post->count ? post->passes[post->count - 1].shader : shaderdefault);
+    BatchBlendMode(blendmode);
+}
+
+void UnloadPostProcess(PostProcess* post) {
+    if (post->scene.framebuffer) UnloadRenderTarget(post->scene);
+    for (int i = 0; i < post->count; ++i) {
+        if (post->passes[i].target.framebuffer) UnloadRenderTarget(post->passes[i].target);
+    }
+    *post = (PostProcess){0};
+}
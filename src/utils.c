@@ -1,6 +1,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -321,6 +322,18 @@ int Scaling(int fontsize) {
     return (fontsize > 0) ? fmax(scaledFontSize, 1) : 0;
 }
 
+// Hashing
+
+// FNV-1a, chain calls starting from 14695981039346656037ull to hash several fields into one key
+static uint64_t Hash64(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 // File checks
 
 bool DirExists(const char* path) {
@@ -357,6 +370,117 @@ int AddWatch(int inotifyFd, const char* filePath) {
     return wd;
 }
 
+// Asset Watcher
+
+typedef void (*WatchCallback)(const char* path, void* user);
+
+typedef struct {
+    char* path;
+    const char* name;      // File name inside path, matched against the directory events
+    int wd;
+    WatchCallback callback;
+    void* user;
+    bool dirty;
+} WatchEntry;
+
+typedef struct {
+    int fd;
+    WatchEntry* entries;
+    size_t count;
+    size_t capacity;
+} AssetWatcher;
+
+AssetWatcher watcher = {-1};
+
+// The parent directory is watched, editors that save through a rename would drop a watch on the file itself
+bool WatchFile(const char* path, WatchCallback callback, void* user) {
+    if (watcher.fd == -1) {
+        watcher.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watcher.fd == -1) {
+            perror("Error initializing inotify");
+            return false;
+        }
+    }
+    char dir[PATH_MAX];
+    const char* slash = strrchr(path, '/');
+    if (slash) {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+        if (dir[0] == '\0') strcpy(dir, "/");
+    } else {
+        strcpy(dir, ".");
+    }
+    // Finished writes and renames into the directory, not every partial write
+        int wd = inotify_add_watch(watcher.fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd == -1) {
+            fprintf(stderr, "Error adding inotify watch for %s\n", dir);
+            return false;
+        }
+    if (watcher.count == watcher.capacity) {
+        watcher.capacity = watcher.capacity ? watcher.capacity * 2 : 16;
+        watcher.entries = realloc(watcher.entries, watcher.capacity * sizeof(WatchEntry));
+    }
+    WatchEntry* entry = &watcher.entries[watcher.count++];
+    entry->path = strdup(path);
+    entry->name = slash ? entry->path + (slash - path) + 1 : entry->path;
+    entry->wd = wd;
+    entry->callback = callback;
+    entry->user = user;
+    entry->dirty = false;
+    return true;
+}
+
+void UnwatchFiles(void* user) {
+    for (size_t i = 0; i < watcher.count;) {
+        if (watcher.entries[i].user == user) {
+            free(watcher.entries[i].path);
+            watcher.entries[i] = watcher.entries[--watcher.count];
+        } else {
+            ++i;
+        }
+    }
+}
+
+// Called once per frame, a save that touches several watched files still fires each callback once
+void WatcherPoll(void) {
+    if (watcher.fd == -1) return;
+    // Drain the pending events
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        bool changed = false;
+        while ((length = read(watcher.fd, buffer, sizeof(buffer))) > 0) {
+            for (char* ptr = buffer; ptr < buffer + length;) {
+                const struct inotify_event* event = (const struct inotify_event*)ptr;
+                ptr += sizeof(struct inotify_event) + event->len;
+                if (event->len == 0 || !(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) continue;
+                for (size_t i = 0; i < watcher.count; ++i) {
+                    WatchEntry* entry = &watcher.entries[i];
+                    if (entry->wd == event->wd && strcmp(entry->name, event->name) == 0) {
+                        entry->dirty = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        if (!changed) return;
+    // Fire the callbacks, the entries may grow while they run
+        for (size_t i = 0; i < watcher.count; ++i) {
+            if (!watcher.entries[i].dirty) continue;
+            watcher.entries[i].dirty = false;
+            for (size_t j = i + 1; j < watcher.count; ++j) {
+                if (watcher.entries[j].callback == watcher.entries[i].callback && watcher.entries[j].user == watcher.entries[i].user) watcher.entries[j].dirty = false;
+            }
+            WatchEntry entry = watcher.entries[i];
+            entry.callback(entry.path, entry.user);
+        }
+}
+
+void WatcherTerminate(void) {
+    for (size_t i = 0; i < watcher.count; ++i) free(watcher.entries[i].path);
+    free(watcher.entries);
+    if (watcher.fd != -1) close(watcher.fd);
+    watcher = (AssetWatcher){-1};
+}
+
 // File Saving
 
 char* FileLoad(const char* path) {
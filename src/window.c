@@ -22,6 +22,7 @@ typedef struct {
     bool        disablecursor;
     bool        hidecursor;
     bool        decorated;
+    bool        headless;
     bool        oldvsync;
     bool        oldhided;
     bool        oldfullscreen;
@@ -44,6 +45,8 @@ typedef struct {
     double                fps;
     int                   samples;
     int                   depthbits;
+    GLuint                framebuffer;
+    GLuint                renderbuffers[2];
     Options               opt;
 } Window;
 
@@ -76,12 +79,15 @@ void WindowFrames() {
 }
 
 void WindowClear() {
+    BatchFlush();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     WindowFrames();
+    UpdateFrameUniforms();
 }
 
 void WindowChecks() {
     mouse = MouseInit();
+    if (window.opt.headless) return;
     if (window.opt.fullscreen != window.opt.oldfullscreen) {
         if (window.opt.fullscreen) {
             glfwSetWindowMonitor(window.w, glfwGetPrimaryMonitor(), 0, 0, window.screen_width, window.screen_width, 0);
@@ -120,11 +126,68 @@ void WindowChecks() {
 }
 
 void WindowProcess() {
+    BatchFrame();
+    CaptureFrame();
+    StreamFrame();
+    TextLayoutFrame();
+    ImageFrame();
+    WatcherPoll();
+    ShaderFrame();
+    StateFrame();
     WindowChecks();
-    glfwSwapBuffers(window.w);
+    if (!window.opt.headless) glfwSwapBuffers(window.w);
     glfwPollEvents();
 }
 
+// Headless
+
+// Offscreen target every draw goes to, it stands in for the default framebuffer
+static bool WindowFramebuffer(void) {
+    glGenFramebuffers(1, &window.framebuffer);
+    glGenRenderbuffers(2, window.renderbuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, window.framebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, window.renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, window.screen_width, window.screen_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, window.renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, window.renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, window.screen_width, window.screen_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, window.renderbuffers[1]);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Failed to create the headless framebuffer\n");
+        return false;
+    }
+    glViewport(0, 0, window.screen_width, window.screen_height);
+    return true;
+}
+
+// No display needed: GLFW's null platform with an EGL context, or OSMesa (llvmpipe) when EGL is missing
+// EGL goes first, with glvnd the GLX build of GLEW resolves through the same dispatch an EGL context uses, an OSMesa one is never reached
+static bool WindowHeadless(void) {
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) {
+        printf("Failed to initialize GLFW\n");
+        return false;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    int apis[] = {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API};
+    for (int i = 0; i < 2 && !window.w; ++i) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, apis[i]);
+        window.w = glfwCreateWindow(window.screen_width, window.screen_height, window.title, NULL, NULL);
+    }
+    if (!window.w) {
+        printf("Failed to create a headless context, EGL or OSMesa is required\n");
+        glfwTerminate();
+        return false;
+    }
+    window.opt.hided = true;
+    window.opt.oldhided = true;
+    return true;
+}
+
 void window_buffersize_callback(GLFWwindow* glfw_window, int width, int height)
 {
     const int MIN_PIXEL = 1;
@@ -140,6 +203,29 @@ int WindowInit(int width, int height, char* title)
     window.height = height;
     window.screen_width = width;
     window.screen_height = height;
+    if (window.opt.headless) {
+        if (!WindowHeadless()) return -1;
+        glfwMakeContextCurrent(window.w);
+        glfwSetErrorCallback(ErrorCallback);
+        glewExperimental = GL_TRUE;
+        GLenum err = glewInit();
+        // Core entry points are loaded before GLEW looks for a GLX display, which a headless context has none of
+        if (err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY) {
+            fprintf(stderr, "Error initializing GLEW: %s\n", glewGetErrorString(err));
+            return -1;
+        }
+        // GLEW reports success even when none of its pointers reach the context
+        if (glGenFramebuffers == NULL || glCreateShader == NULL) {
+            fprintf(stderr, "Error initializing GLEW: no OpenGL entry points resolved for the headless context\n");
+            return -1;
+        }
+        printf("Renderer: %s\n", glGetString(GL_RENDERER));
+        printf("OpenGL version supported %s\n", glGetString(GL_VERSION));
+        if (!WindowFramebuffer()) return -1;
+        InitializeShader();
+        print("Loaded headless\n");
+        return 0;
+    }
     if (!glfwInit()) {
         printf("Failed to initialize GLFW\n");
         return -1;
@@ -212,7 +298,19 @@ void WindowClose()
 {
     print("Exit\n");
     AudioStop();
+    BatchTerminate();
+    InstanceTerminate();
+    ImageTerminate();
+    CaptureTerminate();
+    FreeFontCache();
+    CleanUpTextureCache();
     TerminateShader();
+    WatcherTerminate();
+    if (window.framebuffer) {
+        glDeleteFramebuffers(1, &window.framebuffer);
+        glDeleteRenderbuffers(2, window.renderbuffers);
+        window.framebuffer = 0;
+    }
     glfwDestroyWindow(window.w);
     glfwTerminate();
 }
@@ -23,6 +23,7 @@ typedef struct {
     bool        disablecursor;
     bool        hidecursor;
     bool        decorated;
+    bool        headless;
     bool        oldvsync;
     bool        oldhided;
     bool        oldfullscreen;
@@ -45,6 +46,8 @@ typedef struct {
     double                fps;
     int                   samples;
     int                   depthbits;
+    GLuint                framebuffer;
+    GLuint                renderbuffers[2];
     Options               opt;
 } Window;
 
@@ -174,6 +177,31 @@ extern Window window;
     bool FileExists(const char* filename);
     time_t GetFileModTime(const char* filePath);
     int AddWatch(int inotifyFd, const char* filePath);
+    // Asset watcher
+        typedef void (*WatchCallback)(const char* path, void* user);
+
+        typedef struct {
+            char* path;
+            const char* name;
+            int wd;
+            WatchCallback callback;
+            void* user;
+            bool dirty;
+        } WatchEntry;
+
+        typedef struct {
+            int fd;
+            WatchEntry* entries;
+            size_t count;
+            size_t capacity;
+        } AssetWatcher;
+
+        extern AssetWatcher watcher;
+
+        bool WatchFile(const char* path, WatchCallback callback, void* user);
+        void UnwatchFiles(void* user);
+        void WatcherPoll(void);
+        void WatcherTerminate(void);
     // File saving
     char* FileLoad(const char* path);
     char* FileSave(const char* path, const char* text);
@@ -253,33 +281,230 @@ extern Window window;
     ma_uint32 SoundGetPinnedListenerIndex(const ma_sound* pSound);
     ma_uint32 SoundGetListenerIndex(const ma_sound* pSound);
     ma_vec3f SoundGetDirectionToListener(const ma_sound* pSound);
+// STATE
+    #define STATE_UNKNOWN 0xFFFFFFFFu
+
+    typedef struct {
+        int issued;
+        int skipped;
+    } StateStats;
+
+    typedef struct {
+        GLuint program;
+        GLuint vertexarray;
+        GLuint arraybuffer;
+        GLuint elementbuffer;
+        GLuint uniformbuffer;
+        GLuint texture;
+        GLuint blend;
+        GLenum blendsrc;
+        GLenum blenddst;
+        GLuint depth;
+        GLenum depthfunc;
+        GLuint cull;
+        GLenum cullface;
+        GLenum frontface;
+        GLenum polygonmode;
+        StateStats frame;
+        StateStats stats;
+    } GLState;
+
+    extern GLState glstate;
+
+    // State functions
+        void StateUseProgram(GLuint program);
+        void StateBindVertexArray(GLuint vao);
+        void StateBindBuffer(GLenum target, GLuint buffer);
+        void StateBindTexture(GLuint texture);
+        void StateEnable(GLenum cap, bool enable);
+        void StateBlendFunc(GLenum src, GLenum dst);
+        void StateDepthFunc(GLenum func);
+        void StateCullFace(GLenum face);
+        void StateFrontFace(GLenum face);
+        void StatePolygonMode(GLenum mode);
+        void StateDeleteProgram(GLuint program);
+        void StateDeleteVertexArray(GLuint vao);
+        void StateDeleteBuffer(GLuint buffer);
+        void StateDeleteTexture(GLuint texture);
+        void StateReset(void);
+        void StateFrame(void);
+// STREAM
+    #define STREAM_REGIONS 3
+
+    typedef struct {
+        GLenum target;
+        GLuint buffer;
+        GLsizeiptr size;
+        GLsizeiptr offset;
+        GLsizeiptr used;
+        GLsizeiptr peak;
+        int region;
+        int generation;
+        bool persistent;
+        void* mapped;
+        GLsync fences[STREAM_REGIONS];
+    } StreamBuffer;
+
+    extern StreamBuffer streamvertex;
+    extern StreamBuffer streamindex;
+    extern StreamBuffer streamunpack;
+
+    // Stream functions
+        void StreamInit(StreamBuffer* stream, GLenum target, GLsizeiptr size);
+        GLintptr StreamUpload(StreamBuffer* stream, const void* data, GLsizeiptr size, GLsizeiptr align);
+        void StreamFrame(void);
+        void StreamTerminate(StreamBuffer* stream);
 // SHADER
+    typedef struct {
+        GLint projection;
+        GLint model;
+        GLint view;
+        GLint iTime;
+        GLint iResolution;
+        GLint iMouse;
+        GLint Color;
+        GLint Size;
+    } ShaderLocations;
+
+    typedef struct {
+        char* name;
+        unsigned int hash;
+        GLint location;
+    } ShaderUniform;
+
+    typedef struct {
+        ShaderUniform* slots;
+        size_t capacity;
+        size_t count;
+    } ShaderUniforms;
+
     typedef struct {
         GLuint Program;
         const char* vertex;
         const char* fragment;
-        time_t lastvertmodtime;
-        time_t lastfragmodtime;
+        unsigned int features;   // Feature bits the sources were preprocessed with, see shaderfeatures
         bool hotreloading;
+        ShaderLocations locations;
+        ShaderUniforms* uniforms;
     } Shader;
 
     extern GLuint VAO;
-    extern GLuint VBO;
-    extern GLuint EBO;
+    extern GLuint UBO;
 
     #define FLOAT_PER_VERTEX 5
+    #define FRAME_UNIFORMS_BINDING 0
+
+    #define SHADER_INCLUDE_DEPTH 16
+    #define SHADER_FEATURES_MAX 32
+    #define SHADER_SDF (1u << 0)
+    #define SHADER_CURSOR (1u << 1)
+
+    typedef struct {
+        char** paths;
+        int count;
+    } ShaderIncludes;
 
     extern Shader shaderdefault;
     extern Shader shaderfont;
+    extern Shader shaderfontsdf;
+    extern Shader shaderinstanced;
+    extern Shader shadershape;
 
     // SHADER UTILS
         // Shader Utils
             GLuint CompileShader(const char* shaderSource, GLenum type);
             const char* LoadShaderText(const char* filepath);
             GLuint LinkShaders(const char* vertex, const char* fragment);
+            GLuint LoadShaderProgram(const char* vertex, const char* fragment);
             Shader LoadShader(const char* vertex, const char* fragment);
-            Shader ShaderHotReload(Shader shader);
+            void LoadShaderAsync(Shader* shader, const char* vertex, const char* fragment);
             void DeleteShader(Shader shader);
+        // Shader Preprocessor
+            extern const char* shaderfeatures[SHADER_FEATURES_MAX];
+
+            char* ShaderPreprocess(const char* filepath, unsigned int features, ShaderIncludes* includes);
+        // Program Cache
+            #define PROGRAM_CACHE_MAGIC 0x4E475250
+            #define PROGRAM_CACHE_VERSION 1
+
+            typedef struct {
+                uint32_t magic;
+                uint32_t version;
+                uint64_t key;
+                uint32_t format;
+                uint32_t size;
+            } ProgramCacheHeader;
+
+            typedef struct {
+                const char* dir;
+                bool enabled;
+                int hits;
+                int misses;
+                int rejected;
+            } ProgramCache;
+
+            extern ProgramCache programcache;
+        // Async Compilation
+            typedef struct {
+                GLuint program;
+                GLuint vertex, fragment;
+                Shader* target;
+                int reload;
+                uint64_t key;
+                unsigned long frame;
+            } ShaderJob;
+
+            typedef struct {
+                ShaderJob* jobs;
+                size_t count;
+                size_t capacity;
+                bool parallel;
+                unsigned long frame;
+            } ShaderCompiler;
+
+            extern ShaderCompiler shadercompiler;
+
+            void ShaderCompilerInit(void);
+            void ShaderFrame(void);
+            bool ShaderReady(Shader shader);
+            void ShaderWait(Shader* shader);
+            void ShaderCompilerTerminate(void);
+        // Shader Registry
+            typedef struct {
+                Shader* shaders;
+                size_t count;
+                size_t capacity;
+                int reloads;
+                int failures;
+            } ShaderRegistry;
+
+            extern ShaderRegistry shaderregistry;
+
+            Shader ShaderHotReload(Shader shader);
+            void ShaderRegistryTerminate(void);
+        // Shader Variants
+            typedef struct {
+                uint64_t hash;
+                const char* vertex;
+                const char* fragment;
+                unsigned int features;
+                Shader shader;
+            } ShaderVariant;
+
+            typedef struct {
+                ShaderVariant* slots;
+                size_t capacity;
+                size_t count;
+            } ShaderVariants;
+
+            extern ShaderVariants shadervariants;
+
+            Shader GetShaderVariant(const char* vertex, const char* fragment, unsigned int features);
+            void ShaderVariantsClear(void);
+        // Uniform Locations
+            ShaderLocations GetShaderLocations(GLuint program);
+            GLint GetShaderLocation(Shader shader, const char* var);
+            void ShaderUniformsClear(ShaderUniforms* uniforms);
         // OpenGL Utils
             void UnbindTexture();
             void glTexOpt(GLint filter, GLint warp);
@@ -294,6 +519,7 @@ extern Window window;
         void MatrixMultiply(const GLfloat* a, const GLfloat* b, GLfloat* result);
         void MatrixLookAt(GLfloat eyeX, GLfloat eyeY, GLfloat eyeZ, GLfloat centerX, GLfloat centerY, GLfloat centerZ, GLfloat upX, GLfloat upY, GLfloat upZ, GLfloat* matrix);
         void MatrixRotate(GLfloat angleX, GLfloat angleY, GLfloat angleZ, GLfloat* matrix);
+        void MatrixTRS(Vec3 position, Vec3 rotation, Vec3 scale, Vec3 pivot, GLfloat* matrix);
         void MatrixTranslate(GLfloat tx, GLfloat ty, GLfloat tz, GLfloat *result);
         void MatrixPerspective(GLfloat fov, GLfloat aspect, GLfloat near, GLfloat far, bool is3d, GLfloat* matrix);
         void MatrixOrthographic(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar, GLfloat *matrix);
@@ -353,13 +579,33 @@ extern Window window;
             Camera cam;
         } CubeObject;
 
+        void CalculateModel(ShaderObject obj, GLfloat *Model);
+        void CalculateCamera(ShaderObject obj, GLfloat *Projection, GLfloat *View);
         void CalculateProjections(ShaderObject obj, GLfloat *Model, GLfloat *Projection, GLfloat *View);
+
+        typedef struct {
+            GLfloat projection[16];
+            GLfloat view[16];
+            GLfloat iResolution[2];
+            GLfloat iMouse[2];
+            GLfloat iTime;
+            GLfloat padding[3];
+        } FrameUniforms; // std140 layout of the Frame block
+
+        extern FrameUniforms frameuniforms;
+
+        void SetFrameResolution(int width, int height);
+        void UpdateFrameUniforms(void);
+        void UseFrameUniforms(ShaderObject obj);
+        void SetFrameUniforms(Shader shader);
+        void SetRenderState(ShaderObject obj);
         void RenderShader(ShaderObject obj);
         void Triangle(TriangleObject triangle);
         void Zelda(TriangleObject triangle);
         void Rect(RectObject rect);
         void Cube(CubeObject cube);
 
+    void ShaderAttributes(void);
     void InitializeShader();
     void TerminateShader(void);
 // COLOR
@@ -400,6 +646,8 @@ extern Window window;
     void glColor(Color color);
     void ClearColor(Color color);
 // CACHE
+    #define TEXTURE_CACHE_BUDGET (64 * 1024 * 1024)
+
     typedef struct {
         GLuint texture;
         Color color;
@@ -407,19 +655,112 @@ extern Window window;
         int height;
         bool linear;
         bool isBitmap;
+        uint64_t hash;
+        size_t bytes;
+        int prev, next;
+        bool pinned;
     } CachedTexture;
 
+    typedef struct {
+        CachedTexture* entries;
+        int* slots;
+        size_t capacity;
+        size_t count;
+        size_t entrycapacity;
+        int head, tail;
+        size_t bytes;
+        size_t budget;
+        int hits;
+        int misses;
+        int evictions;
+    } TextureCache;
+
+    extern TextureCache texturecache;
+
     // Texture Cache functions
         GLuint CreateTextureFromBitmap(const unsigned char* bitmapData, int width, int height, bool linear);
         GLuint CreateTextureFromColor(Color color, bool linear);
+        // The name stays valid until a later GetCachedTexture call evicts it, pin it to keep it longer
         GLuint GetCachedTexture(Color color, bool linear, bool isBitmap, const unsigned char* bitmapData, int width, int height);
+        bool PinCachedTexture(GLuint texture, bool pinned);
         void CleanUpTextureCache(void);
+// BATCH
+    #define BATCH_FLOAT_PER_VERTEX 15
+    #define BLEND_ALPHA 0
+    #define BLEND_NONE 1
+    #define BLEND_PREMULTIPLIED 2
+
+    typedef struct {
+        int drawcalls;
+        int vertices;
+        int indices;
+    } BatchStats;
+
+    typedef struct {
+        GLuint VAO;
+        int generation;
+        GLfloat* vertices;
+        GLuint* indices;
+        size_t vertexcount;
+        size_t indexcount;
+        size_t vertexcapacity;
+        size_t indexcapacity;
+        Shader shader;
+        GLuint texture;
+        int blend;
+        int blendmode;
+        Camera cam;
+        BatchStats frame;
+        BatchStats stats;
+    } Batch;
+
+    extern Batch batch;
+
+    // Batch functions
+        void BatchInit(void);
+        void BatchFlush(void);
+        void BatchFrame(void);
+        void BatchBlendMode(int mode);
+        void BatchTriangle(TriangleObject triangle, GLuint texture, Color color);
+        void BatchRect(RectObject rect, GLuint texture, Color color, float u0, float v0, float u1, float v1);
+        void BatchShape(RectObject rect, Color color, float halfWidth, float halfHeight, float radius, float thickness, float start, float end);
+        void BatchTerminate(void);
+// MESH
+    typedef struct {
+        GLuint VAO;
+        GLuint VBO;
+        GLuint EBO;
+        GLsizei indexcount;
+        bool is3d;
+    } Mesh;
+
+    // Mesh functions
+        Mesh LoadMesh(const GLfloat* vertices, size_t vertexcount, const GLuint* indices, size_t indexcount, bool is3d);
+        Mesh LoadMeshCube(float size);
+        void DrawMesh(Mesh mesh, Transform transform, Shader shader, Camera cam);
+        void UnloadMesh(Mesh mesh);
+// INSTANCE
+    #define INSTANCE_FLOAT_PER_INSTANCE 24
+
+    typedef struct {
+        Transform transform;
+        Color color;
+        float u0, v0, u1, v1;
+    } Instance;
+
+    // Instance functions
+        void DrawMeshInstanced(Mesh mesh, const Instance* instances, size_t count, GLuint texture, Shader shader, Camera cam);
+        void DrawCubeInstanced(const Instance* instances, size_t count, float size, GLuint texture);
+        void DrawRectInstanced(const Instance* instances, size_t count, float width, float height, GLuint texture);
+        void InstanceTerminate(void);
 // DRAW
     void DrawRect(int x, int y, int width, int height, Color color);
     void DrawRectBorder(int x, int y, int width, int height, int thickness, Color color);
     void DrawLine(float x0, float y0, float x1, float y1, int thickness, Color color);
     void DrawCircle(int x, int y, int r, Color color);
     void DrawCircleBorder(int x, int y, int r, int thickness, Color color);
+    void DrawRoundedRect(int x, int y, int width, int height, int radius, Color color);
+    void DrawArc(int x, int y, int r, int thickness, float startAngle, float endAngle, Color color);
     void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, Color color);
     void DrawTriangleBorder(int x1, int y1, int x2, int y2, int x3, int y3, int thickness, Color color);
     void DrawCube(GLfloat size, GLfloat x, GLfloat y, GLfloat z, GLfloat rotx, GLfloat roty, GLfloat rotz, Color color);
@@ -428,24 +769,145 @@ extern Window window;
     #include <stb_image.h>
     #define STB_IMAGE_WRITE_IMPLEMENTATION
     #include <stb_image_write.h>
+    #include <pthread.h>
+    #include <sys/stat.h>
     
     typedef struct {
         GLuint raw;         
         unsigned char* data;
         int width, height;  
         int channels;
+        float u0, v0, u1, v1;
     } Img;
 
     typedef struct {
         const char *filename;
         bool nearest;
+        bool mipmap;
+        bool compress;
+        bool cache;
     } ImgInfo;
 
+    #define IMAGE_MAX_LEVELS 16
+
+    typedef struct {
+        unsigned char* pixels[IMAGE_MAX_LEVELS];
+        int width[IMAGE_MAX_LEVELS];
+        int height[IMAGE_MAX_LEVELS];
+        int levels;
+    } ImageLevels;
+
+    #define IMAGE_CACHE_MAGIC 0x58455447
+    #define IMAGE_CACHE_VERSION 1
+
+    typedef struct {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourcesize;
+        int64_t sourcetime;
+        uint32_t width, height;
+        uint32_t format;
+        uint32_t levels;
+    } ImageCacheHeader;
+
+    typedef struct {
+        uint32_t width, height;
+        uint32_t size;
+        uint32_t offset;
+    } ImageCacheLevel;
+
+    typedef struct {
+        const char* dir;
+        int hits;
+        int misses;
+    } ImageCache;
+
+    extern ImageCache imagecache;
+
+    #define IMAGE_WORKERS 4
+    #define IMAGE_UPLOAD_BUDGET (4 * 1024 * 1024)
+    #define IMAGE_PLACEHOLDER (Color){128, 128, 128, 255}
+
+    #define IMAGE_QUEUED   0
+    #define IMAGE_DECODING 1
+    #define IMAGE_DECODED  2
+    #define IMAGE_FAILED   3
+
+    typedef struct {
+        char* filename;
+        GLuint texture;
+        bool nearest;
+        bool mipmap;
+        unsigned char* data;
+        int width, height;
+        int row;
+        int state;
+    } ImageJob;
+
+    typedef struct {
+        pthread_t workers[IMAGE_WORKERS];
+        int workercount;
+        pthread_mutex_t lock;
+        pthread_cond_t wake;
+        bool stop;
+        ImageJob** jobs;
+        int count;
+        int capacity;
+        size_t budget;
+    } ImageLoader;
+
+    extern ImageLoader imageloader;
+
     Img LoadImage(ImgInfo info);
+    Img LoadImageAsync(ImgInfo info);
+    bool ImageReady(Img image);
+    void ImageFrame(void);
+    void ImageTerminate(void);
     void BindImg(Img image);
     void DrawImage(Img image, float x, float y, float width, float height, GLfloat angle);
     void DrawImageShader(Img image, float x, float y, float width, float height, GLfloat angle, Shader shader);
+    #define CAPTURE_SLOTS 3
+    #define CAPTURE_WORKERS 2
+
+    typedef struct {
+        GLuint pbo;
+        GLsizeiptr size;
+        GLsync fence;
+        int serial;
+        int width, height;
+        char* filename;
+    } CaptureSlot;
+
+    typedef struct CaptureJob {
+        unsigned char* pixels;
+        int width, height;
+        char* filename;
+        struct CaptureJob* next;
+    } CaptureJob;
+
+    typedef struct {
+        CaptureSlot slots[CAPTURE_SLOTS];
+        pthread_t workers[CAPTURE_WORKERS];
+        int workercount;
+        pthread_mutex_t lock;
+        pthread_cond_t wake;
+        bool stop;
+        CaptureJob* head;
+        CaptureJob* tail;
+        int pending;
+        char* pattern;
+        int frame;
+        int captured;
+    } Capture;
+
+    extern Capture capture;
+
+    void CaptureScreenshot(const char* filename, int x, int y, int width, int height);
     void SaveScreenshot(const char *filename, int x, int y, int width, int height);
+    void CaptureStart(const char* pattern);
+    void CaptureStop(void);
+    void CaptureFrame(void);
+    void CaptureTerminate(void);
 // FONT
     
     #include <ft2build.h>
@@ -453,6 +915,7 @@ extern Window window;
     #include FT_GLYPH_H
     #include FT_OUTLINE_H
     #include FT_BITMAP_H
+    #include FT_SIZES_H
 
     #define STB_TRUETYPE_IMPLEMENTATION
     #include <stb_truetype.h>
@@ -465,18 +928,65 @@ extern Window window;
         float u1, v1;          // Texture coordinates for the bottom-right corner of the glyph
     } Glyph;
 
-    #define MAX_GLYPHS 256
+    #define ATLAS_FONT_SIZE 128.0
+    #define ATLAS_MAX_SIZE 4096
+    #define ATLAS_PADDING 1
+    #define ATLAS_SDF_SIZE 64.0
+    #define ATLAS_SDF_SPREAD 8
+
+    typedef struct {
+        FT_ULong codepoint;
+        FT_UInt index;
+        Glyph glyph;
+        int shelf;
+        int pins;
+        bool loaded;
+        bool missing;
+    } AtlasGlyph;
+
+    typedef struct {
+        int y;
+        int height;
+        int x;
+        unsigned int tick;
+    } AtlasShelf;
+
+    typedef struct {
+        FT_Face face;
+        FT_Size size;
+        float fontSize;
+        bool subpixel;
+        bool nearest;
+        bool sdf;
+        int channels;
+        GLuint textureID;
+        GLuint* retired;
+        int retiredcount;
+        int width, height;
+        unsigned char* pixels;
+        AtlasShelf* shelves;
+        int shelfcount;
+        int shelfcapacity;
+        int bottom;
+        AtlasGlyph* slots;
+        size_t capacity;
+        size_t count;
+        unsigned int tick;
+        unsigned int version;
+        int lineheight;
+        int rasterized;
+        int evictions;
+    } FontAtlas;
 
     typedef struct {
         FT_Library library;       // FreeType library instance
         FT_Face face;             // Font face
-        unsigned char* atlasData; // Atlas texture data
-        GLuint textureID;         // OpenGL texture ID
-        int atlasWidth;           // Dimensions of the atlas Width
-        int atlasHeight;          // Dimensions of the atlas Height
-        Glyph glyphs[MAX_GLYPHS]; // Glyph data for ASCII characters 32-127
-        float fontSize;           // Font size for which glyphs were generated
+        FontAtlas* atlas;         // Glyphs rasterized on first use
+        int oversampling;         // Dimensions of the oversampling
+        float fontSize;           // Font size for which glyphs are rasterized
         bool nearest;             // Nearest filter
+        bool subpixel;            // Subpixel
+        bool sdf;                 // Signed distance field atlas, crisp at any size
     } Font;
 
     typedef struct {
@@ -484,21 +994,172 @@ extern Window window;
         int height;
     } TextSize;
 
-    typedef struct FontCacheNode {
+    #define TEXT_LAYOUT_CACHE_MAX 1024
+    #define TEXT_LAYOUT_FRAMES 120
+
+    typedef struct {
+        FT_ULong codepoint;
+        int offset;
+        float x, y;
+    } LayoutGlyph;
+
+    typedef struct {
+        FontAtlas* atlas;
         float fontSize;
-        Font font;
-        struct FontCacheNode* next;
-    } FontCacheNode;
+        uint64_t hash;
+        char* text;
+        LayoutGlyph* glyphs;
+        int count;
+        TextSize size;
+        GLfloat* vertices;
+        size_t vertexcount;
+        unsigned int version;
+        int* shelves;
+        int shelfcount;
+        unsigned int frame;
+    } TextLayout;
+
+    typedef struct {
+        TextLayout* entries;
+        int* slots;
+        size_t capacity;
+        size_t count;
+        size_t entrycapacity;
+        unsigned int frame;
+        int hits;
+        int misses;
+    } TextLayoutCache;
+
+    extern TextLayoutCache textlayoutcache;
+
+    typedef struct {
+        char* path;
+        FT_Face face;
+    } FontFace;
+
+    typedef struct {
+        FT_Library library;
+        FontFace* faces;
+        int facecount;
+        int facecapacity;
+        FontAtlas** atlases;
+        size_t capacity;
+        size_t count;
+    } FontRegistry;
+
+    extern FontRegistry fontregistry;
 
     int CalculateAtlasSize(int numGlyphs, float fontSize, int oversampling);
+    FontAtlas* LoadFontAtlas(FT_Face face, float fontSize, bool subpixel, bool nearest, bool sdf);
+    AtlasGlyph* GetFontGlyph(FontAtlas* atlas, FT_ULong codepoint);
+    void SetFontAtlasFilter(FontAtlas* atlas, bool nearest);
+    void UnloadFontAtlas(FontAtlas* atlas);
+    FontAtlas* GetFontAtlas(FT_Face face, float fontSize, bool subpixel, bool nearest, bool sdf);
     Font GenAtlas(Font font);
     Font LoadFont(const char* fontPath);
     Font SetFontSize(Font font, float fontSize);
+    FT_ULong DecodeUTF8(const char* text, size_t* i);
+    void TextLayoutFrame(void);
+    TextLayout* GetTextLayout(Font font, float fontSize, const char* text);
     TextSize GetTextSize(Font font, float fontSize, const char* text);
+    void RenderShaderTextElements(ShaderObject obj, GLuint vao, GLsizei count, GLintptr indexoffset, GLint basevertex, Color color, float fontSize);
     void RenderShaderText(ShaderObject obj, Color color, float fontSize);
+    // Text Mesh
+        typedef struct {
+            GLuint VAO;
+            GLuint VBO;
+            GLuint EBO;
+            GLsizei indexcount;
+            GLintptr indexoffset;
+            GLint basevertex;
+            GLuint texture;
+            float fontSize;
+            FontAtlas* atlas;
+            char* text;
+        } TextMesh;
+
+        TextMesh LoadTextMesh(Font font, float fontSize, const char* text);
+        void DrawTextMesh(TextMesh mesh, int x, int y, Color color);
+        void DrawTextMeshShader(TextMesh mesh, int x, int y, Color color, Shader shader);
+        void UnloadTextMesh(TextMesh mesh);
     void DrawText(int x, int y, Font font, float fontSize, const char* text, Color color);
     void DrawTextEditor(int x, int y, Font font, float fontSize, const char* text, Color color, int cursorStart, int cursorEnd, Shader shaderfont, Shader shaderfontcursor);
     void FreeFontCache();
+// ATLAS
+    #include <stb_rect_pack.h>
+
+    #define TEXTURE_ATLAS_PAGE_SIZE 2048
+    #define TEXTURE_ATLAS_PADDING 1
+
+    typedef struct {
+        GLuint texture;
+        unsigned char* pixels;
+        stbrp_context context;
+        stbrp_node* nodes;
+        bool sealed;
+    } AtlasPage;
+
+    typedef struct {
+        char* name;
+        int page;
+        int x, y, width, height;
+    } AtlasRect;
+
+    typedef struct {
+        AtlasPage* pages;
+        int pagecount;
+        AtlasRect* rects;
+        int rectcount;
+        int rectcapacity;
+        int pagesize;
+        bool nearest;
+    } TextureAtlas;
+
+    TextureAtlas* CreateTextureAtlas(int pageSize, bool nearest);
+    Img AtlasAddBitmap(TextureAtlas* atlas, const char* name, const unsigned char* pixels, int width, int height);
+    Img AtlasAddImage(TextureAtlas* atlas, const char* filename);
+    int AtlasAddDirectory(TextureAtlas* atlas, const char* path);
+    Img GetAtlasImage(TextureAtlas* atlas, const char* name);
+    bool SaveTextureAtlas(TextureAtlas* atlas, const char* path);
+    void UnloadTextureAtlas(TextureAtlas* atlas);
+    TextureAtlas* LoadTextureAtlas(const char* path, bool nearest);
+// TARGET
+    #define RENDER_TARGET_STACK 8
+
+    typedef struct {
+        GLuint framebuffer;
+        GLuint texture;
+        GLuint depth;
+        int width, height;
+        bool nearest;
+    } RenderTarget;
+
+    RenderTarget LoadRenderTarget(int width, int height, bool depth, bool nearest);
+    void BeginRenderTarget(RenderTarget target);
+    void EndRenderTarget(void);
+    void ClearRenderTarget(Color color);
+    Img RenderTargetImage(RenderTarget target);
+    void UnloadRenderTarget(RenderTarget target);
+    // Post Processing
+        #define POST_MAX_PASSES 8
+
+        typedef struct {
+            Shader shader;
+            float scale;
+            RenderTarget target;
+        } PostPass;
+
+        typedef struct {
+            RenderTarget scene;
+            PostPass passes[POST_MAX_PASSES];
+            int count;
+            int width, height;
+        } PostProcess;
+
+        void AddPostPass(PostProcess* post, Shader shader, float scale);
+        void BeginPostProcess(PostProcess* post);
+        void EndPostProcess(PostProcess* post);
+        void UnloadPostProcess(PostProcess* post);
 // END
 
 int WindowInit(int width, int height, char* title);